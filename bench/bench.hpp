@@ -0,0 +1,308 @@
+// Teal Dulcet
+
+// Shared synthetic data generators and timing harness for the microbenchmarks
+
+#include <chrono>
+#include <random>
+#include <sstream>
+
+using namespace std;
+
+// The allocations are counted by the replaced global operator new of the program
+
+namespace bench
+{
+	enum distribution_type
+	{
+		distribution_uniform,
+		distribution_normal,
+		distribution_lognormal
+	};
+
+	const char *const distribution_args[] = {"uniform", "normal", "lognormal"};
+	const distribution_type distribution_types[] = {distribution_uniform, distribution_normal, distribution_lognormal};
+
+	struct options
+	{
+		size_t rows = 1000000;
+		size_t columns = 8;
+		// Width of the text cells
+		size_t width = 8;
+		bool unicode = false;
+		bool ansi = false;
+		distribution_type distribution = distribution_uniform;
+		// Only run the benchmarks whose names contain this
+		const char *filter = "";
+		unsigned repetitions = 5;
+		unsigned jobs = 0;
+		unsigned seed = 1;
+	};
+
+	// Characters of the text cells: ASCII, then two byte Latin, three byte wide CJK and four byte emoji
+	const char *const ascii_chars[] = {"a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l", "m", "n", "o", "p", "q", "r", "s", "t", "u", "v", "w", "x", "y", "z"};
+	const char *const unicode_chars[] = {"é", "ñ", "ü", "ß", "中", "文", "字", "表", "😀", "🎉"};
+
+	// Text table with rows of columns cells, each width characters, separated by separator
+	string text(const options &aoptions, const char separator = ' ')
+	{
+		mt19937_64 engine(aoptions.seed);
+		uniform_int_distribution<size_t> ascii(0, size(ascii_chars) - 1);
+		uniform_int_distribution<size_t> unicode(0, size(unicode_chars) - 1);
+		bernoulli_distribution coin(0.25);
+
+		string buffer;
+		buffer.reserve(aoptions.rows * aoptions.columns * (aoptions.width + 1));
+
+		for (size_t i = 0; i < aoptions.rows; ++i)
+		{
+			for (size_t j = 0; j < aoptions.columns; ++j)
+			{
+				if (j)
+					buffer += separator;
+				if (aoptions.ansi)
+					buffer += "\e[1;3" + to_string(1 + (j % 7)) + 'm';
+				for (size_t k = 0; k < aoptions.width; ++k)
+					buffer += aoptions.unicode and coin(engine) ? unicode_chars[unicode(engine)] : ascii_chars[ascii(engine)];
+				if (aoptions.ansi)
+					buffer += "\e[0m";
+			}
+			buffer += '\n';
+		}
+
+		return buffer;
+	}
+
+	// Numeric table with rows of an increasing x column, then columns - 1 y columns from the distribution
+	string numbers(const options &aoptions, const bool integer, const char separator = ' ')
+	{
+		mt19937_64 engine(aoptions.seed);
+		uniform_real_distribution<double> uniform(-1000, 1000);
+		normal_distribution<double> normal(0, 100);
+		lognormal_distribution<double> lognormal(3, 1);
+
+		string buffer;
+		buffer.reserve(aoptions.rows * aoptions.columns * 12);
+
+		ostringstream strm;
+		strm.precision(integer ? 0 : 10);
+		for (size_t i = 0; i < aoptions.rows; ++i)
+		{
+			buffer += to_string(i);
+			for (size_t j = 1; j < aoptions.columns; ++j)
+			{
+				const double value = aoptions.distribution == distribution_normal ? normal(engine) : aoptions.distribution == distribution_lognormal ? lognormal(engine)
+																																			   : uniform(engine);
+				buffer += separator;
+				if (integer)
+					buffer += to_string(static_cast<long long>(value));
+				else
+				{
+					strm.str("");
+					strm << value;
+					buffer += strm.str();
+				}
+			}
+			buffer += '\n';
+		}
+
+		return buffer;
+	}
+
+	// Output buffer that only counts the characters written, so that the output of a benchmark is not limited by the terminal
+	class nullbuf : public streambuf
+	{
+	public:
+		size_t count = 0;
+
+	protected:
+		int overflow(const int c) override
+		{
+			++count;
+			return c;
+		}
+
+		streamsize xsputn(const char *, const streamsize n) override
+		{
+			count += n;
+			return n;
+		}
+	};
+
+	// Rows of the results table: name, rows/s, MB/s and allocations/op
+	vector<vector<string>> results;
+
+	// Run function() repetitions times, after once to warm up, and record the median time
+	// An op is one call of function(), which processes rows rows and bytes bytes of input (or output for rendering).
+	template <typename F>
+	void run(const options &aoptions, const string &name, const size_t rows, const size_t bytes, const F &function)
+	{
+		if (name.find(aoptions.filter) == string::npos)
+			return;
+
+		function();
+
+		vector<double> times;
+		times.reserve(aoptions.repetitions);
+		const size_t before = allocations;
+
+		for (unsigned i = 0; i < aoptions.repetitions; ++i)
+		{
+			const auto start = chrono::steady_clock::now();
+			function();
+			const auto end = chrono::steady_clock::now();
+			times.push_back(chrono::duration<double>(end - start).count());
+		}
+
+		const size_t allocs = (allocations - before) / max(aoptions.repetitions, 1u);
+
+		sort(times.begin(), times.end());
+		const double time = times.empty() ? 0 : times[times.size() / 2];
+
+		auto format = [](const double value)
+		{
+			ostringstream strm;
+			strm.precision(4);
+			strm << value;
+			return strm.str();
+		};
+
+		results.push_back({name, format(rows / time), bytes ? format(bytes / time / 1e6) : "-", to_string(allocs)});
+	}
+
+	// Output the results table
+	int output(const options &aoptions)
+	{
+		if (results.empty())
+		{
+			cerr << "Error: No benchmarks match " << quoted(aoptions.filter) << ".\n";
+			return 1;
+		}
+
+		const vector<string> header = {"Benchmark", "rows/s", "MB/s", "allocs/op"};
+
+		tables::options tableoptions;
+		tableoptions.headerrow = true;
+		tableoptions.headercolumn = true;
+		tableoptions.alignment = ios_base::right;
+		tableoptions.check = false;
+
+		return tables::array(results, header.data(), nullptr, tableoptions);
+	}
+
+	// Output usage
+	void usage(const char *const programname)
+	{
+		cerr << "Usage:  " << programname << R"( [OPTION(S)]...
+Run the microbenchmarks on synthetic data and output a table of the median rows/s, MB/s and allocations per op (one run of a benchmark).
+
+Options:
+    Mandatory arguments to long options are mandatory for short options too.
+    -r, --rows <ROWS>       Number of rows (default 1000000)
+    -c, --columns <COLUMNS> Number of columns (default 8)
+    -w, --width <WIDTH>     Number of characters in each text cell (default 8)
+    -u, --unicode           Include Unicode characters in the text cells
+    -a, --ansi              Format the text cells with ANSI escape sequences
+    -d, --distribution <DISTRIBUTION> Distribution of the numbers (default 'uniform')
+                                <DISTRIBUTION> can be: uniform, normal, lognormal
+    -f, --filter <NAME>     Only run the benchmarks whose names contain NAME
+    -n, --repetitions <N>   Number of timed runs of each benchmark (default 5)
+    -j, --jobs <JOBS>       Number of threads (default 0)
+                                If JOBS is 0, it will be set to the number of processor cores.
+    -s, --seed <SEED>       Random seed (default 1)
+        --help              Display this help and exit
+)";
+	}
+
+	// Parse the options, returning -1 to continue, otherwise the exit code
+	int parse(int argc, char *argv[], options &aoptions)
+	{
+		static struct option long_options[] = {
+			{"rows", required_argument, nullptr, 'r'},
+			{"columns", required_argument, nullptr, 'c'},
+			{"width", required_argument, nullptr, 'w'},
+			{"unicode", no_argument, nullptr, 'u'},
+			{"ansi", no_argument, nullptr, 'a'},
+			{"distribution", required_argument, nullptr, 'd'},
+			{"filter", required_argument, nullptr, 'f'},
+			{"repetitions", required_argument, nullptr, 'n'},
+			{"jobs", required_argument, nullptr, 'j'},
+			{"seed", required_argument, nullptr, 's'},
+			{"help", no_argument, nullptr, 'h'},
+			{nullptr, 0, nullptr, 0}};
+
+		int option_index = 0;
+		int c = 0;
+
+		while ((c = getopt_long(argc, argv, "ac:d:f:j:n:r:s:uw:", long_options, &option_index)) != -1)
+		{
+			char *p;
+			unsigned long value = 0;
+			if (optarg and c != 'd' and c != 'f')
+			{
+				value = strtoul(optarg, &p, 0);
+				if (*p)
+				{
+					cerr << "Usage: Not a valid integer number: " << quoted(optarg) << ".\n";
+					return 1;
+				}
+			}
+
+			switch (c)
+			{
+			case 'a':
+				aoptions.ansi = true;
+				break;
+			case 'c':
+				aoptions.columns = max(value, 1ul);
+				break;
+			case 'd':
+			{
+				const auto *const end = distribution_args + size(distribution_args);
+				const auto *const it = find_if(distribution_args, end, [](const char *const arg)
+											   { return strcmp(arg, optarg) == 0; });
+				if (it == end)
+				{
+					cerr << "Usage: Invalid argument " << quoted(optarg) << " for --distribution.\n";
+					return 1;
+				}
+				aoptions.distribution = distribution_types[it - distribution_args];
+				break;
+			}
+			case 'f':
+				aoptions.filter = optarg;
+				break;
+			case 'j':
+				aoptions.jobs = value;
+				break;
+			case 'n':
+				aoptions.repetitions = value;
+				break;
+			case 'r':
+				aoptions.rows = value;
+				break;
+			case 's':
+				aoptions.seed = value;
+				break;
+			case 'u':
+				aoptions.unicode = true;
+				break;
+			case 'w':
+				aoptions.width = value;
+				break;
+			case 'h':
+				usage(argv[0]);
+				return 0;
+			default:
+				cerr << "Try '" << argv[0] << " --help' for more information.\n";
+				return 1;
+			}
+		}
+
+		if (!aoptions.jobs)
+			aoptions.jobs = max(thread::hardware_concurrency(), 1u);
+
+		countallocations = true;
+
+		return -1;
+	}
+}
@@ -0,0 +1,154 @@
+// Teal Dulcet
+
+// Microbenchmarks of the graph program: numeric conversion, legend layout and rendering
+
+// Requires downloading both the Table and Graph header only libraries into the parent directory: https://github.com/tdulcet/Table-and-Graph-Libs/blob/master/tables.hpp and https://github.com/tdulcet/Table-and-Graph-Libs/blob/master/graphs.hpp
+
+// Compile: g++ -std=gnu++17 -Wall -g -O3 -flto bench/graph_bench.cpp -o graph_bench
+
+// Run: ./graph_bench [OPTION(S)]...
+
+#define main graph_main
+#include "../graph.cpp"
+#undef main
+
+#include "bench.hpp"
+
+// Parse the numbers of the buffer into series, with the same conversion as the program
+template <typename T>
+series<T> ainput(const string &buffer, const bool fast, const unsigned jobs)
+{
+	auto convert = [fast](const string_view &token, T &number, const size_t line, ostream &err)
+	{
+		if (fast)
+			return fromchars(token, number, line, err);
+		thread_local string temp;
+		temp = token;
+		return tonumber(temp.c_str(), number, 0, err);
+	};
+
+	series<T> aseries;
+	input(string_view(buffer), delimiters(nullptr, '\n'), true, false, {}, aseries, jobs, convert);
+	return aseries;
+}
+
+int main(int argc, char *argv[])
+{
+	bench::options aoptions;
+	const int code = bench::parse(argc, argv, aoptions);
+	if (code != -1)
+		return code;
+
+	const string integers = bench::numbers(aoptions, true);
+	const string floats = bench::numbers(aoptions, false);
+	const size_t rows = aoptions.rows;
+
+	bench::run(aoptions, "ainput intmax_t", rows, integers.size(), [&]()
+			   { ainput<intmax_t>(integers, false, aoptions.jobs); });
+
+	bench::run(aoptions, "ainput long double", rows, floats.size(), [&]()
+			   { ainput<long double>(floats, false, aoptions.jobs); });
+
+	bench::run(aoptions, "ainput double", rows, floats.size(), [&]()
+			   { ainput<double>(floats, true, aoptions.jobs); });
+
+	bench::run(aoptions, "ainput long double 1 job", rows, floats.size(), [&]()
+			   { ainput<long double>(floats, false, 1); });
+
+	{
+		// The same numbers as packed little-endian doubles
+		string binary;
+		binary.reserve(rows * aoptions.columns * sizeof(double));
+		istringstream strm(floats);
+		for (double number; strm >> number;)
+		{
+			char data[sizeof(number)];
+			memcpy(data, &number, sizeof(number));
+			binary.append(data, sizeof(number));
+		}
+
+		bench::run(aoptions, "decode f64le", rows, binary.size(), [&]()
+				   {
+			series<double> aseries;
+			decode(string_view(binary), format_f64le, aoptions.columns, {}, false, true, 0, aseries, aoptions.jobs); });
+	}
+
+	{
+		// One legend entry for each row, with the text of the first column as the name
+		const vector<vector<string_view>> tokens = [&]()
+		{
+			bench::options toptions = aoptions;
+			toptions.columns = 1;
+			toptions.rows = min<size_t>(aoptions.rows, 10000);
+			static const string text = bench::text(toptions);
+			vector<vector<string_view>> atokens;
+			size_t start = 0;
+			for (size_t end; (end = text.find('\n', start)) != string::npos; start = end + 1)
+				atokens.push_back({string_view(text).substr(start, end - start)});
+			return atokens;
+		}();
+
+		vector<array<string, 2>> aarray;
+		for (const auto &row : tokens)
+			aarray.push_back({"*", string(row[0])});
+
+		tables::options tableoptions;
+		tableoptions.check = false;
+
+		bench::nullbuf buf;
+		auto *const old = cout.rdbuf(&buf);
+
+		auto acolumn = [&]()
+		{ column(160, aarray, tableoptions); };
+
+		acolumn();
+		bench::run(aoptions, "column", aarray.size(), buf.count, acolumn);
+
+		cout.rdbuf(old);
+	}
+
+	{
+		series<long double> aseries = ainput<long double>(floats, true, aoptions.jobs);
+		const vector<vector<array<long double, 2>>> &aarray = aseries.arrays;
+		size_t points = 0;
+		for (const auto &array : aarray)
+			points += array.size();
+
+		graphs::options graphoptions;
+		graphoptions.check = false;
+
+		bench::nullbuf buf;
+		auto *const old = cout.rdbuf(&buf);
+
+		// The number of bytes output by a single run
+		auto output = [&buf](const auto &function)
+		{
+			buf.count = 0;
+			function();
+			return buf.count;
+		};
+
+		auto aplots = [&]()
+		{ graphs::plots(160, 160, 0, 0, 0, 0, aarray, graphoptions); };
+
+		bench::run(aoptions, "graphs::plots", points, output(aplots), aplots);
+
+		auto decimated = aarray;
+		for (auto &array : decimated)
+			decimate(array, 160 * 2, 160 * 3, 0, rows, -1e6, 1e6);
+
+		auto adecimated = [&]()
+		{ graphs::plots(160, 160, 0, 0, 0, 0, decimated, graphoptions); };
+
+		bench::run(aoptions, "graphs::plots decimated", points, output(adecimated), adecimated);
+
+		auto ahistogram = [&]()
+		{ graphs::histogram(160, 160, 0, 0, 0, 0, xvalues<long double>(aarray[0]), graphoptions); };
+
+		bench::run(aoptions, "graphs::histogram", aarray[0].size(), output(ahistogram), ahistogram);
+
+		cout.rdbuf(old);
+	}
+
+	return bench::output(aoptions);
+}
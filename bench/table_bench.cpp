@@ -0,0 +1,115 @@
+// Teal Dulcet
+
+// Microbenchmarks of the table program: parsing, tokenizing and rendering
+
+// Requires downloading the Table header only library into the parent directory: https://github.com/tdulcet/Table-and-Graph-Libs/blob/master/tables.hpp
+
+// Compile: g++ -std=gnu++17 -Wall -g -O3 -flto bench/table_bench.cpp -o table_bench
+
+// Run: ./table_bench [OPTION(S)]...
+
+#define main table_main
+#include "../table.cpp"
+#undef main
+
+#include "bench.hpp"
+
+int main(int argc, char *argv[])
+{
+	bench::options aoptions;
+	const int code = bench::parse(argc, argv, aoptions);
+	if (code != -1)
+		return code;
+
+	const string text = bench::text(aoptions);
+	const string tabs = bench::text(aoptions, '\t');
+	const string csv = bench::text(aoptions, ',');
+	const size_t rows = aoptions.rows;
+	list<string> escaped;
+
+	// Every cell quoted, with a separator and an escaped quote in each
+	string quoted;
+	quoted.reserve(csv.size() * 2);
+	for (size_t start = 0, end; (end = csv.find_first_of(",\n", start)) != string::npos; start = end + 1)
+		quoted.append(1, '"').append(csv, start, end - start).append("\"\",x\"").append(1, csv[end]);
+
+	bench::run(aoptions, "input whitespace", rows, text.size(), [&]()
+			   { input(string_view(text), nullptr, '\n', false, {}, false, aoptions.jobs, escaped); });
+
+	bench::run(aoptions, "input whitespace 1 job", rows, text.size(), [&]()
+			   { input(string_view(text), nullptr, '\n', false, {}, false, 1, escaped); });
+
+	bench::run(aoptions, "input separator", rows, tabs.size(), [&]()
+			   { input(string_view(tabs), "\t", '\n', false, {}, false, aoptions.jobs, escaped); });
+
+	bench::run(aoptions, "input separator 1 job", rows, tabs.size(), [&]()
+			   { input(string_view(tabs), "\t", '\n', false, {}, false, 1, escaped); });
+
+	// Only the first and last columns, like cut -f
+	selection fields;
+	fields.parse("1," + to_string(aoptions.columns));
+
+	bench::run(aoptions, "input separator fields", rows, tabs.size(), [&]()
+			   { input(string_view(tabs), "\t", '\n', false, fields, false, aoptions.jobs, escaped); });
+
+	bench::run(aoptions, "input csv", rows, csv.size(), [&]()
+			   { input(string_view(csv), ",", '\n', true, {}, false, aoptions.jobs, escaped); });
+
+	bench::run(aoptions, "input csv 1 job", rows, csv.size(), [&]()
+			   { input(string_view(csv), ",", '\n', true, {}, false, 1, escaped); });
+
+	bench::run(aoptions, "input csv quoted", rows, quoted.size(), [&]()
+			   {
+		input(string_view(quoted), ",", '\n', true, {}, false, aoptions.jobs, escaped);
+		escaped.clear(); });
+
+	{
+		const delimiters whitespace(nullptr, '\n');
+		const delimiters separator("\t", '\n');
+		vector<string_view> tokens;
+
+		auto atokenize = [&](const string &buffer, const delimiters &adelimiters)
+		{
+			size_t start = 0;
+			for (size_t end; (end = buffer.find('\n', start)) != string::npos; start = end + 1)
+			{
+				tokens.clear();
+				tokenize(string_view(buffer).substr(start, end - start), adelimiters, tokens);
+			}
+		};
+
+		bench::run(aoptions, "tokenize whitespace", rows, text.size(), [&]()
+				   { atokenize(text, whitespace); });
+
+		bench::run(aoptions, "tokenize separator", rows, tabs.size(), [&]()
+				   { atokenize(tabs, separator); });
+	}
+
+	{
+		const cellarray<string_view> aarray = input(string_view(text), nullptr, '\n', false, {}, false, aoptions.jobs, escaped);
+
+		bench::run(aoptions, "fit", rows, text.size(), [&]()
+				   {
+			size_t width;
+			for (const auto &array : aarray)
+				for (const auto &cell : array)
+					fit(cell, SIZE_MAX, width); });
+
+		tables::options tableoptions;
+		tableoptions.check = false;
+
+		bench::nullbuf buf;
+		auto *const old = cout.rdbuf(&buf);
+
+		auto output = [&]()
+		{ tables::array(aarray, nullptr, nullptr, tableoptions); };
+
+		// The number of bytes output by a single run
+		output();
+		bench::run(aoptions, "tables::array", rows, buf.count, output);
+
+		cout.rdbuf(old);
+	}
+
+	return bench::output(aoptions);
+}
@@ -8,9 +8,29 @@
 // Run: ./graph [OPTION(S)]... [FILE(S)]...
 
 #include <fstream>
+#include <atomic>
 #include <climits>
 #include <cinttypes>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <dlfcn.h>
 #include <getopt.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 
 #include "tables.hpp"
 #include "graphs.hpp"
@@ -21,6 +41,23 @@ enum
 {
 	X_UNITS_OPTION = CHAR_MAX + 1,
 	Y_UNITS_OPTION,
+	FOLLOW_OPTION,
+	POINTS_OPTION,
+	SPAN_OPTION,
+	INTERVAL_OPTION,
+	PRECISION_OPTION,
+	NO_DECIMATE_OPTION,
+	BINS_OPTION,
+	STATS_OPTION,
+	PROFILE_OPTION,
+	INPUT_FORMAT_OPTION,
+	BINARY_COLUMNS_OPTION,
+	INDEX_OPTION,
+	CSV_OPTION,
+	TSV_OPTION,
+	FIELDS_OPTION,
+	HEAD_OPTION,
+	TAIL_OPTION,
 	GETOPT_HELP_CHAR = CHAR_MIN - 2,
 	GETOPT_VERSION_CHAR = CHAR_MIN - 3
 };
@@ -35,6 +72,42 @@ const char *const mark_args[] = {"dot", "plus", "square"};
 
 const char *const units_args[] = {"number", "si", "iec", "iec-i", "fracts", "percent", "date", "time", "monetary"};
 
+enum precision_type
+{
+	precision_long_double,
+	precision_double
+};
+
+const char *const precision_args[] = {"long-double", "double"};
+
+enum precision_type const precision_types[] = {precision_long_double, precision_double};
+
+enum profile_type
+{
+	profile_text,
+	profile_json
+};
+
+const char *const profile_args[] = {"text", "json"};
+
+enum profile_type const profile_types[] = {profile_text, profile_json};
+
+enum format_type
+{
+	format_text,
+	format_f64le,
+	format_f32le,
+	format_i64le,
+	format_i32le
+};
+
+const char *const format_args[] = {"text", "f64le", "f32le", "i64le", "i32le"};
+
+enum format_type const format_types[] = {format_text, format_f64le, format_f32le, format_i64le, format_i32le};
+
+// Size of the numbers of each binary format
+const size_t format_sizes[] = {0, 8, 4, 8, 4};
+
 // Check if the argument is in the argument list
 template <typename T>
 T xargmatch(const char *const context, const char *const arg, const char *const *arglist, const size_t argsize, const T vallist[])
@@ -51,52 +124,153 @@ T xargmatch(const char *const context, const char *const arg, const char *const
 	// return -1;
 }
 
+// Check if [first, last) only has printable ASCII characters, which are each one terminal column wide, so that the display width is the length
+bool printable_scalar(const char *first, const char *last)
+{
+	for (; first < last; ++first)
+		if (*first < ' ' or *first > '~')
+			return false;
+
+	return true;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2"))) bool printable_sse2(const char *first, const char *last)
+{
+	// The bytes are signed, so the non-ASCII bytes are less than the space
+	const __m128i low = _mm_set1_epi8(' ' - 1);
+	const __m128i high = _mm_set1_epi8('~' + 1);
+
+	for (; last - first >= 16; first += 16)
+	{
+		const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+		const __m128i match = _mm_and_si128(_mm_cmpgt_epi8(block, low), _mm_cmplt_epi8(block, high));
+		if (_mm_movemask_epi8(match) != 0xFFFF)
+			return false;
+	}
+
+	return printable_scalar(first, last);
+}
+
+__attribute__((target("avx2"))) bool printable_avx2(const char *first, const char *last)
+{
+	const __m256i low = _mm256_set1_epi8(' ' - 1);
+	const __m256i high = _mm256_set1_epi8('~' + 1);
+
+	for (; last - first >= 32; first += 32)
+	{
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+		const __m256i match = _mm256_and_si256(_mm256_cmpgt_epi8(block, low), _mm256_cmpgt_epi8(high, block));
+		if (static_cast<unsigned>(_mm256_movemask_epi8(match)) != 0xFFFFFFFF)
+			return false;
+	}
+
+	return printable_sse2(first, last);
+}
+#endif
+
+bool printable(const string_view &str)
+{
+	using printable_type = bool (*)(const char *, const char *);
+
+	static const printable_type best = []
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+			return printable_avx2;
+		if (__builtin_cpu_supports("sse2"))
+			return printable_sse2;
+#endif
+		return printable_scalar;
+	}();
+
+	return best(str.data(), str.data() + str.size());
+}
+
+// Get the display width of str, skipping ANSI escape sequences
+int strcol(const string &str)
+{
+	if (printable(str))
+		return str.size();
+
+	return tables::strcol(str.c_str());
+}
+
+// Output the rows of array as a table, with as many rows on each line as fit in width terminal columns
 template <typename T>
 int column(const size_t width, const T &array, const tables::options &aoptions)
 {
 	const size_t rows = array.size();
 	const size_t columns = array[0].size();
+	const size_t total = rows * columns;
 
-	vector<vector<int>> rowwidth(rows, vector<int>(columns));
+	// Display width of each cell, in row-major order
+	vector<size_t> cellwidth(total);
 
 	for (size_t i = 0; i < rows; ++i)
 	{
 		for (size_t j = 0; j < columns; ++j)
-			rowwidth[i][j] = tables::strcol(array[i][j].c_str());
+			cellwidth[(i * columns) + j] = max(strcol(array[i][j]), 0);
 	}
 
-	const size_t total = rows * columns;
-	size_t acolumns = total;
+	const bool border = aoptions.tableborder or aoptions.cellborder or aoptions.headerrow or aoptions.headercolumn;
+
+	// Width of the padding and borders of a table with acolumns columns
+	auto padding = [&](const size_t acolumns)
+	{
+		return border ? (((2 * aoptions.padding) + 1) * acolumns) + (aoptions.tableborder ? 1 : -1) : (2 * aoptions.padding) * acolumns;
+	};
+
+	// The first line has the first rows, so their total width is a lower bound that only increases with the number of rows on each line
+	vector<size_t> prefix(rows + 1);
+
+	for (size_t i = 0; i < rows; ++i)
+		prefix[i + 1] = prefix[i] + accumulate(cellwidth.cbegin() + (i * columns), cellwidth.cbegin() + ((i + 1) * columns), size_t(0));
+
+	size_t low = 1;
+	size_t high = rows;
+
+	while (low < high)
+	{
+		const size_t mid = low + ((high - low + 1) / 2);
+
+		if (prefix[mid] + padding(mid * columns) <= width)
+			low = mid;
+		else
+			high = mid - 1;
+	}
+
+	// The actual width does not always increase with the number of rows on each line, so each is checked from that bound down until one fits, stopping each check as soon as it is too wide
+	vector<size_t> columnwidth;
+	size_t acolumns = low * columns;
 
 	for (; acolumns > columns; acolumns -= columns)
 	{
-		vector<int> columnwidth(acolumns);
+		columnwidth.assign(acolumns, 0);
+
+		size_t awidth = padding(acolumns);
+		bool fits = true;
 
-		for (size_t i = 0; i < rows; ++i)
+		for (size_t i = 0; i < total and fits; ++i)
 		{
-			const size_t k = (i * columns) % acolumns;
+			size_t &acolumnwidth = columnwidth[i % acolumns];
 
-			for (size_t j = 0; j < columns; ++j)
+			if (cellwidth[i] > acolumnwidth)
 			{
-				if (rowwidth[i][j] > columnwidth[k + j])
-					columnwidth[k + j] = rowwidth[i][j];
+				awidth += cellwidth[i] - acolumnwidth;
+				acolumnwidth = cellwidth[i];
+				fits = awidth <= width;
 			}
 		}
 
-		size_t awidth = accumulate(columnwidth.cbegin(), columnwidth.cend(), 0ul);
-
-		if (aoptions.tableborder or aoptions.cellborder or aoptions.headerrow or aoptions.headercolumn)
-			awidth += (((2 * aoptions.padding) + 1) * acolumns) + (aoptions.tableborder ? 1 : -1);
-		else
-			awidth += (2 * aoptions.padding) * acolumns;
-
-		if (awidth <= width)
+		if (fits)
 			break;
 	}
 
 	const size_t arows = (total + acolumns - 1) / acolumns;
 
-	vector<vector<string>> aarray(arows);
+	vector<vector<typename T::value_type::value_type>> aarray(arows);
 
 	for (size_t i = 0; i < rows; ++i)
 	{
@@ -114,206 +288,2462 @@ int column(const size_t width, const T &array, const tables::options &aoptions)
 	return tables::array(aarray, headerrow, headercolumn, aoptions);
 }
 
-template <typename T>
-vector<basic_string<T>> split(const basic_string<T> &s, const T delim = ',')
+// Buffer for standard output, which is written with a few large write() calls instead of one for each piece of the output
+// SGR escape sequences that would not change the text attributes, such as a reset followed by the same color again, are skipped.
+class outputbuf : public streambuf
 {
-	basic_istringstream<T> ss(s);
-	basic_string<T> item;
-	vector<basic_string<T>> result;
+	ostream &strm;
+	streambuf *const original;
+	const int fd;
+	vector<char> buffer;
+	size_t size = 0;
+	bool failed = false;
 
-	while (getline(ss, item, delim))
+	// Escape sequence that has not been completed yet
+	string escape;
+	// Only SGR sequence since the last reset
+	string last;
+	size_t sequences = 0;
+	// A reset that has been deferred until the next output
+	bool reset = false;
+	// The text attributes are known to be the defaults
+	bool clean = false;
+
+	bool write()
 	{
-		result.push_back(item);
+		const char *data = buffer.data();
+		while (size and !failed)
+		{
+			const ssize_t n = ::write(fd, data, size);
+			if (n == -1)
+			{
+				if (errno == EINTR)
+					continue;
+				failed = true;
+				break;
+			}
+			data += n;
+			size -= n;
+		}
+		size = 0;
+		return !failed;
 	}
 
-	return result;
-}
+	void put(const char *s, size_t n)
+	{
+		while (n)
+		{
+			if (size == buffer.size())
+				write();
+			const size_t count = min(n, buffer.size() - size);
+			memcpy(buffer.data() + size, s, count);
+			size += count;
+			s += count;
+			n -= count;
+		}
+	}
 
-template <typename T>
-vector<vector<basic_string<T>>> input(basic_istream<T> &in, const char *delimiter, const char line_delim)
-{
-	vector<vector<basic_string<T>>> aarray;
+	// Output the deferred reset, if any
+	void pending()
+	{
+		if (!reset)
+			return;
+		put("\e[0m", 4);
+		reset = false;
+		clean = true;
+		last.clear();
+		sequences = 0;
+	}
 
-	basic_string<T> line;
-	while (getline(in, line, line_delim))
+	// Output a complete escape sequence
+	void sequence()
 	{
-		if (!line.empty())
+		if (escape.back() != 'm')
+		{
+			pending();
+			put(escape.data(), escape.size());
+			return;
+		}
+
+		if (escape == "\e[m" or escape == "\e[0m")
 		{
-			vector<basic_string<T>> array;
+			if (!clean)
+				reset = true;
+			return;
+		}
+
+		// Setting the same attributes again, with or without a reset in between, does not change them
+		if (sequences == 1 and escape == last)
+		{
+			reset = false;
+			return;
+		}
 
-			if (delimiter)
+		pending();
+		put(escape.data(), escape.size());
+		clean = false;
+		if (!sequences++)
+			last = escape;
+	}
+
+	void output(const char *s, size_t n)
+	{
+		while (n)
+		{
+			if (escape.empty())
 			{
-				size_t pos = 0;
-				do
+				const char *const end = static_cast<const char *>(memchr(s, '\e', n));
+				const size_t count = end ? end - s : n;
+				if (count)
 				{
-					const size_t end = line.find_first_of(delimiter, pos);
-					array.push_back(line.substr(pos, end - pos));
-					pos = end != basic_string<T>::npos ? end + 1 : end;
-				} while (pos != basic_string<T>::npos);
+					pending();
+					put(s, count);
+				}
+				if (end)
+					escape = '\e';
+				const size_t skip = end ? count + 1 : count;
+				s += skip;
+				n -= skip;
+				continue;
 			}
-			else
+
+			// Control sequences are ESC [, then parameter and intermediate bytes, then a final byte
+			const unsigned char c = *s;
+			if (escape.size() == 1 ? c == '[' : c >= 0x20 and c <= 0x7E and escape.size() < 64)
 			{
-				basic_istringstream<T> ss(line);
-				basic_string<T> token;
-				while (ss >> token)
+				escape += *s;
+				++s;
+				--n;
+				if (escape.size() > 2 and c >= 0x40)
 				{
-					array.push_back(token);
+					sequence();
+					escape.clear();
 				}
 			}
+			else
+			{
+				// Not a control sequence, so it is output unchanged
+				pending();
+				put(escape.data(), escape.size());
+				clean = false;
+				escape.clear();
+			}
+		}
+	}
 
-			aarray.push_back(array);
+protected:
+	int overflow(const int c) override
+	{
+		if (c != traits_type::eof())
+		{
+			const char ch = c;
+			output(&ch, 1);
 		}
+		return failed ? traits_type::eof() : traits_type::not_eof(c);
 	}
 
-	return aarray;
-}
+	streamsize xsputn(const char *s, const streamsize n) override
+	{
+		output(s, n);
+		return failed ? 0 : n;
+	}
 
-// Output usage
-void usage(const char *const programname)
-{
-	cerr << "Usage:  " << programname << R"( [OPTION(S)]... [FILE(S)]...
-or:     )"
-		 << programname << R"d( <OPTION>
-Convert input into a graph/plot. With no FILE, or when FILE is -, read from standard input. Empty lines are ignored. With a single input, each row can have one or more columns in the form 'x y1 ... yn', which will be converted to 'x y1' ... 'x yn'. With a single input and column it will output a histogram, otherwise it will output a plot. With multiple inputs, rows should have exactly two columns in the form 'x y'. See examples below.
+	int sync() override
+	{
+		pending();
+		return write() ? 0 : -1;
+	}
 
-Options:
-    Mandatory arguments to long options are mandatory for short options too.
-    -t, --title <TITLE>     Graph Name/Title
-        --name <TITLE>          Show a title above the graph. The title is word wrapped based on the current width of the terminal.
-    -h, --height <HEIGHT>   Graph height (default 0)
-                                If HEIGHT is 0, it will be set to the current height of the terminal (number of rows).
-    -w, --width <WIDTH>     Graph width (default 0)
-                                If WIDTH is 0, it will be set to the current width of the terminal (number of columns).
-    -x, --x-min <XMIN>      Minimum x value (default 0)
-                                If XMIN and XMAX are both 0, they will be set to the respective minimum and maximum values of x in the input.
-    -X, --x-max <XMAX>      Maximum x value (default 0)
-                                If XMIN and XMAX are both 0, they will be set to the respective minimum and maximum values of x in the input.
-    -y, --y-min <YMIN>      Minimum y value (default 0)
-                                If YMIN and YMAX are both 0, they will be set to the respective minimum and maximum values of y in the input.
-    -Y, --y-max <YMAX>      Maximum y value (default 0)
-                                If YMIN and YMAX are both 0, they will be set to the respective minimum and maximum values of y in the input.
-    -C, --type <TYPE>       Type (default 'braille')
-                                <TYPE> can be:
-                                    braille:                  Braille (default)
-                                    block:                    Block
-                                    block-quadrant:           Block quadrant
-                                    separated-block-quadrant: Separated block quadrant
-                                    block-sextant:            Block sextant
-                                    separated-block-sextant:  Separated block sextant
-                                    block-octant:             Block octant
-    -m, --mark <MARK>       Mark type (default 'dot')
-                                <MARK> can be:
-                                    dot:            Dot (default)
-                                    plus:           Plus
-                                    square:         Square
-    -b, --border            Border
-                                Show graph and legend border.
-    -a, --no-axis           No axis
-                                Do not show the axis. Implies --no-axis-labels, --no-ticks and --no-units-labels.
-    -l, --no-axis-labels    No axis labels
-    -T, --no-ticks          No axis tick marks
-                                Implies --no-units-labels.
-    -u, --no-units-labels   No axis units labels
-        --x-units <UNIT>    X-axis units format (default 'fracts')
-                                See UNIT below.
-        --y-units <UNIT>    Y-axis units format (default 'fracts')
-                                See UNIT below.
-    -n, --names <NAMES>     Series names
-                                Provide either a comma separated list of names or specify this option multiple times, once for each input/series.
-    -L, --legend            Legend
-                                Show a legend below the graph. Uses the --names values or the first line/row of each input if that options is not provided.
-    -s, --separator <SEP>   Characters to delimit columns/fields (default any whitespace)
-    -d, --delimiter <SEP>   
-    -z, --zero-terminated   Line delimiter is NUL, not newline
-    -i, --int               Integer numbers
-                                Read input values as integer numbers. Supports all Integer numbers )d"
-		 << INTMAX_MIN << " - " << INTMAX_MAX << R"d(.
-    -f, --float             Floating point numbers (default)
-                                Read input values as floating point numbers. Supports all Floating point numbers )d"
-		 << LDBL_MIN << " - " << LDBL_MAX << R"d(.
-    -S, --style <STYLE>     Border style (default 'light')
-                                <STYLE> can be:
-                                    ascii:          ASCII
-                                    basic:          Basic
-                                    light:          Light (default)
-                                    heavy:          Heavy
-                                    double:         Double
-                                    arc:            Light Arc
-                                    light-dashed:   Light Dashed
-                                    heavy-dashed:   Heavy Dashed
-    -c, --color <COLOR>     Graph/Plot color (default 'red')
-                                Used only when plotting a single input/series. Otherwise, colors red - bright white (2 - 16) are used inorder. The system default color is used where the plots cross. <COLOR> can be:
-                                    default:        System default
-                                    black:          Black
-                                    red:            Red (default)
-                                    green:          Green
-                                    yellow:         Yellow
-                                    blue:           Blue
-                                    magenta:        Magenta
-                                    cyan:           Cyan
-                                    white:          White
-                                    gray:           Gray
-                                    bright-red:     Bright Red
-                                    bright-green:   Bright Green
-                                    bright-yellow:  Bright Yellow
-                                    bright-blue:    Bright Blue
-                                    bright-magenta: Bright Magenta
-                                    bright-cyan:    Bright Cyan
-                                    bright-white:   Bright White
+public:
+	outputbuf(ostream &strm, const int fd) : strm(strm), original(strm.rdbuf(this)), fd(fd), buffer(1 << 20) {}
 
-        --help              Display this help and exit
-        --version           Output version information and exit
+	~outputbuf()
+	{
+		put(escape.data(), escape.size());
+		sync();
+		strm.rdbuf(original);
+	}
+};
 
-UNIT options:
-    number:         Locale number format (similar to 'numfmt --grouping')
-                        e.g. 1234.25 → 1,234.25
-    si:             Auto-scale to the SI standard (similar to 'numfmt --to=si')
-                        e.g. 1000 → 1K
-    iec:            Auto-scale to the IEC standard (similar to 'numfmt --to=iec')
-                        e.g. 1024 → 1K
-    iec-i:          Auto-scale to the IEC standard (similar to 'numfmt --to=iec-i')
-                        e.g. 1024 → 1Ki
-    fracts:         Locale number format, but convert fractions and mathematical constants to Unicode characters (default)
-                        e.g. 1234.25 → 1,234¼
-    percent:        Percentage format
-                        e.g. 0.123 → 12.3%
-    date:           Locale date format (same as 'date +%x')
-                        e.g. 2147483647 → 01/19/2038
-    time:           Locale time format (same as 'date +%X')
-                        e.g. 2147483647 → 03:14:07 AM
-    monetary:       Locale monetary/currency format (does not work with the ‘C’ locale)
-                        e.g. 123 → $1.23
+// Number of allocations, counted by the replaced global operator new with --profile
+atomic<size_t> allocations(0);
+bool countallocations = false;
 
-Examples:
-    Output plot
-    $ printf '1 1\n2 2\n3 3\n4 4\n5 5\n6 6\n' | )d"
-		 << programname << R"d( --height 20 --width 40 --x-min -10 --x-max 10 --y-min -10 --y-max 10
+// The replaced operators allocate with malloc() and free with free(), which GCC would report as mismatched wherever they are inlined
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
 
-    Output plot of single series (Bash Syntax)
-    $ for i in {-20..20}; do echo "$i $(( i + 1 ))"; done | )d"
-		 << programname << R"d( --height 40 --width 80 --x-min -20 --x-max 20 --y-min -20 --y-max 20
+void *operator new(size_t size)
+{
+	if (countallocations)
+		allocations.fetch_add(1, memory_order_relaxed);
+	if (void *const ptr = malloc(size ? size : 1))
+		return ptr;
+	throw bad_alloc();
+}
 
-    Output plot of multiple series (Bash Syntax)
-    $ for i in {-20..20}; do echo "$i $(( 2 * i )) $(( i ** 2 ))"; done | )d"
-		 << programname << R"d( --height 40 --width 80 --x-min -20 --x-max 20 --y-min -20 --y-max 20
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
 
-    Output graph of multiple functions
-    $ awk 'BEGIN { pi=atan2(0, -1); width=160; xmin=-(2*pi); xmax=2*pi; xstep=(xmax-xmin)/width; for(i=0; i<width*2; ++i) { x=((i/2)*xstep)+xmin; print x,sin(x),cos(x),sin(x)/cos(x) } }' | )d"
-		 << programname << R"d( --height 40 --width 80 --y-min -4 --y-max 4 --no-units-labels
+void operator delete(void *ptr) noexcept
+{
+	free(ptr);
+}
 
-    Output a plot in each style (Bash syntax)
-    $ for s in ascii basic light heavy double arc light-dashed heavy-dashed; do for i in {0..9}; do echo "$i $(( i + 1 ))"; done | )d"
-		 << programname << R"( --height 20 --width 40 --x-min -10 --x-max 10 --y-min -10 --y-max 10 --style=$s --title "Style: $s"; done
+void operator delete[](void *ptr) noexcept
+{
+	free(ptr);
+}
 
-)";
+void operator delete(void *ptr, size_t) noexcept
+{
+	free(ptr);
 }
 
-int main(int argc, char *argv[])
+void operator delete[](void *ptr, size_t) noexcept
 {
-	size_t height = 0;
-	size_t width = 0;
+	free(ptr);
+}
 
-	long double xmin = -0;
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+// Number of bytes read from the inputs
+atomic<size_t> bytesread(0);
+
+// Set when an input could not be read or decompressed, so that the program exits with an error
+atomic<bool> readerror(false);
+
+// Time of each phase of the program and throughput, output to standard error with --profile
+class profiler
+{
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	chrono::steady_clock::time_point last = start;
+	vector<pair<const char *, double>> phases;
+
+public:
+	bool enabled = false;
+	profile_type format = profile_text;
+	size_t rows = 0;
+	size_t cells = 0;
+
+	// Record the time since the end of the previous phase
+	void phase(const char *const name)
+	{
+		const auto now = chrono::steady_clock::now();
+		phases.emplace_back(name, chrono::duration<double>(now - last).count());
+		last = now;
+	}
+
+	// The last phase writes the buffered output
+	~profiler()
+	{
+		if (!enabled)
+			return;
+
+		cout.flush();
+		phase("write");
+
+		const double total = chrono::duration<double>(last - start).count();
+		const size_t bytes = bytesread;
+
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		const size_t rss = usage.ru_maxrss * 1024;
+
+		ostringstream strm;
+		if (format == profile_json)
+		{
+			strm << "{\"phases\": {";
+			for (size_t i = 0; i < phases.size(); ++i)
+				strm << (i ? ", " : "") << '"' << phases[i].first << "\": " << phases[i].second;
+			strm << "}, \"total\": " << total << ", \"bytes\": " << bytes << ", \"rows\": " << rows << ", \"cells\": " << cells << ", \"allocations\": " << allocations << ", \"peak_rss\": " << rss << "}\n";
+		}
+		else
+		{
+			strm << "Profile:\n";
+			for (const auto &[name, time] : phases)
+				strm << "    " << left << setw(12) << name << right << setw(12) << fixed << setprecision(6) << time << " s (" << setw(5) << setprecision(1) << (total > 0 ? time / total * 100 : 0) << "%)\n";
+			strm << "    " << left << setw(12) << "total" << right << setw(12) << setprecision(6) << total << " s\n";
+			strm << defaultfloat << setprecision(4);
+			strm << "Bytes read:  " << bytes << " (" << (total > 0 ? bytes / total / 1e6 : 0) << " MB/s)\n";
+			strm << "Rows:        " << rows << " (" << (total > 0 ? rows / total : 0) << " rows/s)\n";
+			strm << "Cells:       " << cells << " (" << (total > 0 ? cells / total : 0) << " cells/s)\n";
+			strm << "Allocations: " << allocations << '\n';
+			strm << "Peak RSS:    " << rss << " bytes\n";
+		}
+		cerr << strm.str();
+	}
+};
+
+template <typename T>
+vector<basic_string<T>> split(const basic_string<T> &s, const T delim = ',')
+{
+	basic_istringstream<T> ss(s);
+	basic_string<T> item;
+	vector<basic_string<T>> result;
+
+	while (getline(ss, item, delim))
+	{
+		result.push_back(item);
+	}
+
+	return result;
+}
+
+// Fields to keep from each row, from a list of fields and ranges of fields like cut -f (e.g. 1,3,7-9 or 5-)
+// The fields are numbered from 1 in the list and from 0 otherwise. All fields are kept by default.
+class selection
+{
+	vector<bool> fields;
+	// All fields from this one on are kept
+	size_t from = 0;
+
+public:
+	// Keep only the fields in list, returns false if it is not valid
+	bool parse(const string &list);
+
+	bool all() const { return !from; }
+
+	// Check if field i is kept
+	bool operator[](const size_t i) const { return i >= from or (i < fields.size() and fields[i]); }
+
+	// Get the number of fields after which none are kept, or SIZE_MAX if there is no such field
+	size_t end() const { return from == SIZE_MAX ? fields.size() : SIZE_MAX; }
+};
+
+bool selection::parse(const string &list)
+{
+	fields.clear();
+	from = SIZE_MAX;
+
+	const vector<string> tokens = split(list);
+	if (tokens.empty())
+		return false;
+
+	for (const auto &token : tokens)
+	{
+		const char *p = token.c_str();
+		char *q;
+		errno = 0;
+
+		size_t first = 1;
+		if (isdigit(*p))
+		{
+			first = strtoul(p, &q, 10);
+			p = q;
+		}
+		size_t last = first;
+		if (*p == '-')
+		{
+			++p;
+			last = SIZE_MAX;
+			if (isdigit(*p))
+			{
+				last = strtoul(p, &q, 10);
+				p = q;
+			}
+		}
+
+		if (*p or token.empty() or token == "-" or !first or first > last or errno == ERANGE)
+			return false;
+
+		if (last == SIZE_MAX)
+			from = min(from, first - 1);
+		else
+		{
+			if (fields.size() < last)
+				fields.resize(last);
+			fill(fields.begin() + (first - 1), fields.begin() + last, true);
+		}
+	}
+
+	if (from != SIZE_MAX)
+		fields.resize(min(fields.size(), from));
+
+	return true;
+}
+
+// Field and line delimiters
+// The function to find the next delimiter is selected at runtime for the CPU, so that it can check 16, 32 or 64 bytes at a time with SIMD instructions.
+class delimiters
+{
+	using find_type = const char *(*)(const char *, const char *, const delimiters &);
+	find_type afind;
+
+public:
+	// Most delimiters that are checked with SIMD instructions
+	static constexpr size_t max_chars = 16;
+
+	bool table[256] = {};
+	alignas(16) char chars[max_chars] = {};
+	int count = 0;
+	const bool whitespace;
+	const char line_delim;
+	// Fields can be quoted, as in CSV and TSV files
+	const bool quoted;
+	// Fields to keep, the others are skipped
+	const selection fields;
+
+	delimiters(const char *delimiter, char line_delim, bool quoted = false, selection fields = {});
+
+	// Find the first delimiter in [first, last), or last if there is none
+	const char *find(const char *first, const char *last) const { return afind(first, last, *this); }
+};
+
+const char *find_scalar(const char *first, const char *last, const delimiters &set)
+{
+	for (; first < last; ++first)
+		if (set.table[static_cast<unsigned char>(*first)])
+			return first;
+
+	return last;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse4.2"))) const char *find_sse42(const char *first, const char *last, const delimiters &set)
+{
+	const __m128i aset = _mm_load_si128(reinterpret_cast<const __m128i *>(set.chars));
+
+	for (; last - first >= 16; first += 16)
+	{
+		const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+		const int index = _mm_cmpestri(aset, set.count, block, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+		if (index < 16)
+			return first + index;
+	}
+
+	return find_scalar(first, last, set);
+}
+
+__attribute__((target("avx2"))) const char *find_avx2(const char *first, const char *last, const delimiters &set)
+{
+	__m256i aset[delimiters::max_chars];
+	for (int i = 0; i < set.count; ++i)
+		aset[i] = _mm256_set1_epi8(set.chars[i]);
+
+	for (; last - first >= 32; first += 32)
+	{
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+		__m256i match = _mm256_cmpeq_epi8(block, aset[0]);
+		for (int i = 1; i < set.count; ++i)
+			match = _mm256_or_si256(match, _mm256_cmpeq_epi8(block, aset[i]));
+		const unsigned mask = _mm256_movemask_epi8(match);
+		if (mask)
+			return first + __builtin_ctz(mask);
+	}
+
+	return find_scalar(first, last, set);
+}
+
+__attribute__((target("avx512bw"))) const char *find_avx512(const char *first, const char *last, const delimiters &set)
+{
+	__m512i aset[delimiters::max_chars];
+	for (int i = 0; i < set.count; ++i)
+		aset[i] = _mm512_set1_epi8(set.chars[i]);
+
+	for (; last - first >= 64; first += 64)
+	{
+		const __m512i block = _mm512_loadu_si512(first);
+		__mmask64 mask = 0;
+		for (int i = 0; i < set.count; ++i)
+			mask |= _mm512_cmpeq_epi8_mask(block, aset[i]);
+		if (mask)
+			return first + __builtin_ctzll(mask);
+	}
+
+	return find_scalar(first, last, set);
+}
+#endif
+
+delimiters::delimiters(const char *delimiter, const char line_delim, const bool quoted, selection fields) : whitespace(!delimiter), line_delim(line_delim), quoted(quoted), fields(move(fields))
+{
+	// Same characters as isspace() in the "C" locale, which operator>> uses to skip whitespace
+	const char *const chars = whitespace ? " \t\n\v\f\r" : delimiter;
+
+	table[static_cast<unsigned char>(line_delim)] = true;
+	for (const char *c = chars; *c; ++c)
+		table[static_cast<unsigned char>(*c)] = true;
+
+	bool simd = true;
+	for (size_t i = 0; i < size(table); ++i)
+	{
+		if (table[i])
+		{
+			if (count < static_cast<int>(max_chars))
+				this->chars[count++] = static_cast<char>(i);
+			else
+				simd = false;
+		}
+	}
+
+	static const find_type best = []
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512bw"))
+			return find_avx512;
+		if (__builtin_cpu_supports("avx2"))
+			return find_avx2;
+		if (__builtin_cpu_supports("sse4.2"))
+			return find_sse42;
+#endif
+		return find_scalar;
+	}();
+
+	afind = simd ? best : find_scalar;
+}
+
+// Split a line into fields, skipping the fields that are not selected
+template <typename T>
+void tokenize(const basic_string_view<T> &line, const delimiters &adelimiters, vector<basic_string_view<T>> &array)
+{
+	const selection &fields = adelimiters.fields;
+	const size_t last = fields.end();
+	const T *p = line.data();
+	const T *const end = p + line.size();
+
+	if (adelimiters.whitespace)
+	{
+		for (size_t i = 0; i < last; ++i)
+		{
+			while (p < end and adelimiters.table[static_cast<unsigned char>(*p)])
+				++p;
+			if (p == end)
+				break;
+			const T *const q = adelimiters.find(p, end);
+			if (fields[i])
+				array.emplace_back(p, q - p);
+			p = q;
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < last; ++i)
+		{
+			const T *const q = adelimiters.find(p, end);
+			if (fields[i])
+				array.emplace_back(p, q - p);
+			if (q == end)
+				break;
+			p = q + 1;
+		}
+	}
+}
+
+// Split a line of a CSV or TSV file into fields (RFC 4180)
+// Quoted fields can contain the field delimiters and escaped quotes (""), which are replaced with one quote in escaped, so that the field is a view into it. A carriage return at the end of the line is removed. The fields that are not selected are skipped.
+void tokenize(string_view line, const delimiters &adelimiters, vector<string_view> &array, string &escaped)
+{
+	const selection &fields = adelimiters.fields;
+	const size_t last = fields.end();
+
+	if (adelimiters.line_delim == '\n' and !line.empty() and line.back() == '\r')
+		line.remove_suffix(1);
+
+	// The fields are never longer than the line, so the views into escaped stay valid
+	escaped.clear();
+	escaped.reserve(line.size());
+
+	const char *p = line.data();
+	const char *const end = p + line.size();
+	for (size_t i = 0; i < last; ++i)
+	{
+		// Find the closing quote, skipping the escaped quotes
+		const char *r = nullptr;
+		bool escapes = false;
+		if (p < end and *p == '"')
+		{
+			r = p + 1;
+			while ((r = static_cast<const char *>(memchr(r, '"', end - r))) and r + 1 < end and r[1] == '"')
+			{
+				r += 2;
+				escapes = true;
+			}
+		}
+
+		const char *q;
+		if (r)
+		{
+			string_view field(p + 1, r - p - 1);
+			if (fields[i] and escapes)
+			{
+				const size_t start = escaped.size();
+				for (size_t i = 0; i < field.size(); ++i)
+				{
+					escaped += field[i];
+					if (field[i] == '"')
+						++i;
+				}
+				field = string_view(escaped).substr(start);
+			}
+			if (fields[i])
+				array.push_back(field);
+
+			// Any characters after the closing quote are ignored
+			q = adelimiters.find(r + 1, end);
+		}
+		else
+		{
+			q = adelimiters.find(p, end);
+			if (fields[i])
+				array.emplace_back(p, q - p);
+		}
+
+		if (q == end)
+			break;
+		p = q + 1;
+	}
+}
+
+// Call function(i) for each i in [0, n), using up to jobs threads
+template <typename F>
+void parallel(const size_t n, const unsigned jobs, const F &function)
+{
+	atomic<size_t> next = 0;
+
+	auto worker = [&]()
+	{
+		for (size_t i; (i = next++) < n;)
+			function(i);
+	};
+
+	vector<thread> threads;
+	for (size_t i = 1; i < min(static_cast<size_t>(jobs), n); ++i)
+		threads.emplace_back(worker);
+
+	worker();
+
+	for (auto &athread : threads)
+		athread.join();
+}
+
+// Points of the series of an input, stored contiguously so that they can be passed to the graph library without copying
+template <typename T>
+struct series
+{
+	vector<vector<array<T, 2>>> arrays;
+	// Legend names, from the first row
+	vector<string> names;
+	// First conversion error of each series
+	vector<string> errors;
+	size_t rows = 0;
+	size_t cells = 0;
+	size_t minwidth = SIZE_MAX;
+	size_t maxwidth = 0;
+};
+
+// View of the x values of a series of points, so that a histogram is output from the same storage as a plot
+template <typename T>
+class xvalues
+{
+	const vector<array<T, 2>> &points;
+
+public:
+	class iterator
+	{
+		typename vector<array<T, 2>>::const_iterator it;
+
+	public:
+		using iterator_category = forward_iterator_tag;
+		using value_type = T;
+		using difference_type = ptrdiff_t;
+		using pointer = const T *;
+		using reference = const T &;
+
+		iterator() = default;
+		explicit iterator(const typename vector<array<T, 2>>::const_iterator &ait) : it(ait) {}
+
+		reference operator*() const { return (*it)[0]; }
+		pointer operator->() const { return &(*it)[0]; }
+
+		iterator &operator++()
+		{
+			++it;
+			return *this;
+		}
+
+		iterator operator++(int)
+		{
+			const iterator temp = *this;
+			++it;
+			return temp;
+		}
+
+		bool operator==(const iterator &other) const { return it == other.it; }
+		bool operator!=(const iterator &other) const { return it != other.it; }
+	};
+
+	explicit xvalues(const vector<array<T, 2>> &apoints) : points(apoints) {}
+
+	iterator begin() const { return iterator(points.cbegin()); }
+	iterator end() const { return iterator(points.cend()); }
+	size_t size() const { return points.size(); }
+	bool empty() const { return points.empty(); }
+	const T &operator[](const size_t i) const { return points[i][0]; }
+};
+
+// Counts of the values in equal width bins from min to max, so that a histogram only needs constant memory
+// The range is half-open, unless closed is true, in which case the values equal to max are added to the last bin.
+class bins
+{
+public:
+	vector<size_t> counts;
+	long double min = 0;
+	long double max = 0;
+	bool closed = false;
+	size_t total = 0;
+
+	bins(const size_t n, const long double amin, const long double amax, const bool aclosed = false) : counts(n), min(amin), max(amax), closed(aclosed) {}
+
+	long double step() const { return (max - min) / counts.size(); }
+
+	// Returns false if the value is outside of the range
+	bool add(const long double x, const size_t count = 1)
+	{
+		if (!(x >= min and (x < max or (closed and x == max))))
+			return false;
+
+		// Also when the values are all the same
+		const long double index = (x - min) / step();
+		counts[index < counts.size() - 1 ? static_cast<size_t>(index) : counts.size() - 1] += count;
+		total += count;
+
+		return true;
+	}
+
+	// Double the range towards the value until it is within it, merging pairs of adjacent bins
+	void grow(const long double x)
+	{
+		const size_t n = counts.size();
+
+		while (x < min or x >= max)
+		{
+			const long double width = max - min;
+			if (x >= max)
+			{
+				for (size_t i = 0; i < n; ++i)
+					counts[i] = 2 * i < n ? counts[2 * i] + (2 * i + 1 < n ? counts[2 * i + 1] : 0) : 0;
+				max += width;
+			}
+			else
+			{
+				for (size_t i = 0; i < n; ++i)
+					counts[n - 1 - i] = 2 * i < n ? counts[n - 1 - 2 * i] + (2 * i + 1 < n ? counts[n - 2 - 2 * i] : 0) : 0;
+				min -= width;
+			}
+		}
+	}
+
+	void merge(const bins &other)
+	{
+		for (size_t i = 0; i < counts.size(); ++i)
+			counts[i] += other.counts[i];
+		total += other.total;
+	}
+};
+
+// Values at the center of each bin, each repeated for the count of the bin, so that a histogram is output from only the counts
+class binvalues
+{
+	const vector<size_t> &counts;
+	vector<long double> centers;
+
+public:
+	class iterator
+	{
+		const binvalues *values = nullptr;
+		size_t index = 0;
+		size_t repeat = 0;
+
+		void skip()
+		{
+			while (index < values->counts.size() and !values->counts[index])
+				++index;
+		}
+
+	public:
+		using iterator_category = forward_iterator_tag;
+		using value_type = long double;
+		using difference_type = ptrdiff_t;
+		using pointer = const long double *;
+		using reference = const long double &;
+
+		iterator() = default;
+		iterator(const binvalues *avalues, const size_t aindex) : values(avalues), index(aindex) { skip(); }
+
+		reference operator*() const { return values->centers[index]; }
+		pointer operator->() const { return &values->centers[index]; }
+
+		iterator &operator++()
+		{
+			if (++repeat == values->counts[index])
+			{
+				repeat = 0;
+				++index;
+				skip();
+			}
+			return *this;
+		}
+
+		iterator operator++(int)
+		{
+			const iterator temp = *this;
+			++*this;
+			return temp;
+		}
+
+		bool operator==(const iterator &other) const { return index == other.index and repeat == other.repeat; }
+		bool operator!=(const iterator &other) const { return !(*this == other); }
+	};
+
+	binvalues(const vector<size_t> &acounts, const long double min, const long double step) : counts(acounts), centers(acounts.size())
+	{
+		for (size_t i = 0; i < centers.size(); ++i)
+			centers[i] = min + (i + 0.5) * step;
+	}
+
+	iterator begin() const { return iterator(this, 0); }
+	iterator end() const { return iterator(this, counts.size()); }
+	size_t size() const { return accumulate(counts.cbegin(), counts.cend(), size_t(0)); }
+	bool empty() const { return begin() == end(); }
+};
+
+// Summary of a stream of numbers: count, minimum, maximum, mean, standard deviation and quantiles
+// The quantiles are estimated with a t-digest, which keeps the numbers in at most about compression * log(count) weighted centroids, with the smallest near the minimum and maximum, so it uses bounded memory. Summaries can be merged, so that parts of the input can be summarized on separate threads.
+class summary
+{
+	static constexpr long double compression = 200;
+	static constexpr size_t buffer_size = 4096;
+
+	// Mean and count of each centroid, sorted by mean
+	vector<pair<long double, long double>> centroids;
+	// Numbers and centroids that have not been merged into the centroids yet
+	vector<pair<long double, long double>> buffer;
+
+	void compress()
+	{
+		if (buffer.empty())
+			return;
+
+		buffer.insert(buffer.end(), centroids.cbegin(), centroids.cend());
+		sort(buffer.begin(), buffer.end());
+		centroids.clear();
+
+		long double total = 0;
+		for (const auto &centroid : buffer)
+			total += centroid.second;
+
+		// Merge adjacent centroids while their combined count is within the size limit of their quantile
+		long double sofar = 0;
+		auto current = buffer.front();
+		for (size_t i = 1; i < buffer.size(); ++i)
+		{
+			const long double proposed = current.second + buffer[i].second;
+			const long double q0 = sofar / total;
+			const long double q2 = (sofar + proposed) / total;
+
+			if (proposed <= total * std::min(q0 * (1 - q0), q2 * (1 - q2)) * 4 / compression)
+			{
+				current.first += (buffer[i].first - current.first) * buffer[i].second / proposed;
+				current.second = proposed;
+			}
+			else
+			{
+				sofar += current.second;
+				centroids.push_back(current);
+				current = buffer[i];
+			}
+		}
+		centroids.push_back(current);
+
+		buffer.clear();
+	}
+
+public:
+	size_t count = 0;
+	long double min = numeric_limits<long double>::infinity();
+	long double max = -numeric_limits<long double>::infinity();
+	long double mean = 0;
+	// Sum of the squared differences from the mean
+	long double m2 = 0;
+
+	void add(const long double x)
+	{
+		// NaN is not a number, and would break the ordering of the buffer
+		if (isnan(x))
+			return;
+
+		++count;
+		min = std::min(min, x);
+		max = std::max(max, x);
+
+		const long double delta = x - mean;
+		mean += delta / count;
+		m2 += delta * (x - mean);
+
+		buffer.emplace_back(x, 1);
+		if (buffer.size() >= buffer_size)
+			compress();
+	}
+
+	void merge(const summary &other)
+	{
+		if (!other.count)
+			return;
+
+		const size_t n = count + other.count;
+		const long double delta = other.mean - mean;
+		mean += delta * other.count / n;
+		m2 += other.m2 + delta * delta * count * other.count / n;
+		count = n;
+		min = std::min(min, other.min);
+		max = std::max(max, other.max);
+
+		buffer.insert(buffer.end(), other.centroids.cbegin(), other.centroids.cend());
+		buffer.insert(buffer.end(), other.buffer.cbegin(), other.buffer.cend());
+		compress();
+	}
+
+	long double stddev() const { return count > 1 ? sqrt(m2 / (count - 1)) : 0; }
+
+	// Interpolates between the means of the centroids, which each represent the numbers around the middle of their count
+	long double quantile(const long double q)
+	{
+		compress();
+
+		if (centroids.empty())
+			return numeric_limits<long double>::quiet_NaN();
+
+		const long double rank = q * count;
+
+		long double sofar = 0;
+		long double previous = min;
+		long double center = 0;
+		for (const auto &[amean, acount] : centroids)
+		{
+			const long double acenter = sofar + (acount / 2);
+			if (rank < acenter)
+				return previous + (amean - previous) * (center < acenter ? (rank - center) / (acenter - center) : 0);
+
+			sofar += acount;
+			previous = amean;
+			center = acenter;
+		}
+
+		return previous + (max - previous) * (count > center ? (rank - center) / (count - center) : 0);
+	}
+};
+
+// Call function(tokens, line) with the fields of each line of a buffer of whole lines, skipping empty lines
+// Returns the line number of the last line, starting from line.
+template <typename F>
+size_t rows(const string_view &buffer, const delimiters &adelimiters, size_t line, const F &function)
+{
+	const char line_delim = adelimiters.line_delim;
+
+	vector<string_view> tokens;
+	string escaped;
+
+	const char *p = buffer.data();
+	const char *const end = p + buffer.size();
+	while (p < end)
+	{
+		++line;
+
+		const char *q = static_cast<const char *>(memchr(p, line_delim, end - p));
+		if (!q)
+			q = end;
+
+		if (q != p)
+		{
+			tokens.clear();
+			if (adelimiters.quoted)
+				tokenize(string_view(p, q - p), adelimiters, tokens, escaped);
+			else
+				tokenize(string_view(p, q - p), adelimiters, tokens);
+
+			function(tokens, line);
+		}
+
+		p = q + 1;
+	}
+
+	return line;
+}
+
+// Convert a buffer of whole lines directly into points, skipping empty lines
+// With a single input, each row "x y1 y2 ... yn" adds a point to each of the first n series, otherwise only "x y1" is used. Missing values are 0.
+// If header is true, the first row is instead used for the legend names. Returns the line number of the last line, starting from line.
+template <typename T, typename F>
+size_t parse(const string_view &buffer, const delimiters &adelimiters, const bool single, size_t line, bool &header, series<T> &aseries, const F &convert)
+{
+	ostringstream err;
+	string xerror;
+
+	return rows(buffer, adelimiters, line, [&](const vector<string_view> &tokens, const size_t aline)
+				{
+		++aseries.rows;
+		aseries.cells += tokens.size();
+		aseries.minwidth = min(aseries.minwidth, tokens.size());
+		aseries.maxwidth = max(aseries.maxwidth, tokens.size());
+
+		if (header)
+		{
+			header = false;
+			for (size_t j = 1; j < (single ? tokens.size() : min(tokens.size(), size_t(2))); ++j)
+				aseries.names.emplace_back(tokens[j]);
+			return;
+		}
+
+		const size_t n = single ? max(tokens.size(), size_t(2)) - 1 : 1;
+		if (aseries.arrays.size() < n)
+		{
+			aseries.arrays.resize(n);
+			aseries.errors.resize(n);
+		}
+
+		T x = 0;
+		xerror.clear();
+		if (!tokens.empty() and !convert(tokens[0], x, aline, err))
+		{
+			xerror = err.str();
+			err.str("");
+		}
+
+		for (size_t j = 0; j < n; ++j)
+		{
+			T y = 0;
+			const bool valid = j + 1 >= tokens.size() or convert(tokens[j + 1], y, aline, err);
+
+			if ((!xerror.empty() or !valid) and aseries.errors[j].empty())
+				aseries.errors[j] = !xerror.empty() ? xerror : err.str();
+			if (!valid)
+				err.str("");
+
+			aseries.arrays[j].push_back({x, y});
+		} });
+}
+
+// Split the buffer into up to jobs chunks of at least 1 MiB, which each end after a line delimiter
+template <typename T>
+vector<basic_string_view<T>> chunk(const basic_string_view<T> &buffer, const char line_delim, const unsigned jobs)
+{
+	const size_t n = max(min(static_cast<size_t>(jobs), buffer.size() >> 20), size_t(1));
+
+	vector<basic_string_view<T>> chunks;
+	chunks.reserve(n);
+
+	size_t start = 0;
+	for (size_t i = 1; i <= n and start < buffer.size(); ++i)
+	{
+		size_t end = buffer.size();
+		if (i < n)
+		{
+			end = buffer.find(line_delim, max(start, (buffer.size() / n) * i));
+			end = end != basic_string_view<T>::npos ? end + 1 : buffer.size();
+		}
+
+		chunks.push_back(buffer.substr(start, end - start));
+		start = end;
+	}
+
+	return chunks;
+}
+
+// Line number before each chunk, starting from line, for error messages
+template <typename T>
+vector<size_t> lines(const vector<basic_string_view<T>> &chunks, const char line_delim, size_t line, const unsigned jobs)
+{
+	vector<size_t> alines(chunks.size());
+
+	parallel(chunks.size(), jobs, [&](const size_t i)
+			 { alines[i] = count(chunks[i].cbegin(), chunks[i].cend(), line_delim); });
+
+	for (size_t i = 0; i < chunks.size(); ++i)
+	{
+		const size_t count = alines[i];
+		alines[i] = line;
+		line += count;
+	}
+
+	return alines;
+}
+
+// Limits on the number of rows of each input, from --head and --tail
+struct limits
+{
+	// Rows at the start that are always kept and not counted, such as a header row
+	size_t first = 0;
+	// Rows left to keep from the start, reading stops when there are none
+	size_t head = SIZE_MAX;
+	// Only the last rows are kept
+	size_t tail = SIZE_MAX;
+};
+
+// Get the end of the next rows of a buffer of whole lines, from start, after the line delimiter of the last one
+// Empty lines are not rows. The number of rows is decremented for each row found, so that it can be continued with the next buffer. SIZE_MAX rows is no limit, so the buffer is not searched.
+size_t headrows(const string_view &buffer, size_t start, size_t &rows, const char line_delim)
+{
+	if (rows == SIZE_MAX)
+		return buffer.size();
+
+	while (rows and start < buffer.size())
+	{
+		const size_t end = min(buffer.find(line_delim, start), buffer.size());
+		if (end != start)
+			--rows;
+		start = min(end + 1, buffer.size());
+	}
+
+	return start;
+}
+
+// Get the start of the last rows of a buffer of whole lines, searching backwards from the end, so that only the end of a mapped file is read
+size_t tailrows(const string_view &buffer, size_t rows, const char line_delim)
+{
+	if (!rows)
+		return buffer.size();
+	if (buffer.empty())
+		return 0;
+
+	const char *const data = buffer.data();
+	size_t end = buffer.size();
+	if (data[end - 1] == line_delim)
+		--end;
+
+	for (;;)
+	{
+		const char *const p = static_cast<const char *>(memrchr(data, line_delim, end));
+		const size_t start = p ? p - data + 1 : 0;
+		if (start != end and !--rows)
+			return start;
+		if (!p)
+			return 0;
+		end = p - data;
+	}
+}
+
+// Get the rows of a buffer of whole lines that are kept with the --head and --tail limits
+string_view limitrows(const string_view &buffer, limits alimits, const char line_delim)
+{
+	const string_view abuffer = buffer.substr(0, headrows(buffer, 0, alimits.head, line_delim));
+
+	return alimits.tail != SIZE_MAX ? abuffer.substr(tailrows(abuffer, alimits.tail, line_delim)) : abuffer;
+}
+
+// Parse each chunk of the buffer on its own thread, then join their points in order
+// Only the rows after the header that are kept with the --head and --tail limits are parsed.
+template <typename T, typename F>
+void input(string_view buffer, const delimiters &adelimiters, const bool single, bool header, limits alimits, series<T> &aseries, const unsigned jobs, const F &convert)
+{
+	const char line_delim = adelimiters.line_delim;
+	size_t line = 0;
+
+	// The header can be preceded by empty lines, so it is parsed before the buffer is split
+	while (header and !buffer.empty())
+	{
+		size_t end = buffer.find(line_delim);
+		end = end != string_view::npos ? end + 1 : buffer.size();
+
+		line = parse(buffer.substr(0, end), adelimiters, single, line, header, aseries, convert);
+		buffer.remove_prefix(end);
+	}
+
+	buffer = limitrows(buffer, alimits, line_delim);
+
+	const vector<string_view> chunks = chunk(buffer, line_delim, jobs);
+	const vector<size_t> alines = lines(chunks, line_delim, line, jobs);
+
+	// The first chunk is parsed directly into the series, which the others are then appended to
+	vector<series<T>> aaseries(chunks.size());
+
+	parallel(chunks.size(), jobs, [&](const size_t i)
+			 {
+		bool aheader = false;
+		parse(chunks[i], adelimiters, single, alines[i], aheader, i ? aaseries[i] : aseries, convert); });
+
+	for (size_t i = 1; i < chunks.size(); ++i)
+	{
+		const auto &temp = aaseries[i];
+		aseries.rows += temp.rows;
+		aseries.cells += temp.cells;
+		aseries.minwidth = min(aseries.minwidth, temp.minwidth);
+		aseries.maxwidth = max(aseries.maxwidth, temp.maxwidth);
+
+		if (aseries.arrays.size() < temp.arrays.size())
+		{
+			aseries.arrays.resize(temp.arrays.size());
+			aseries.errors.resize(temp.arrays.size());
+		}
+	}
+
+	for (size_t j = 0; j < aseries.arrays.size(); ++j)
+	{
+		auto &points = aseries.arrays[j];
+
+		size_t size = points.size();
+		for (size_t i = 1; i < chunks.size(); ++i)
+			if (j < aaseries[i].arrays.size())
+				size += aaseries[i].arrays[j].size();
+		points.reserve(size);
+
+		for (size_t i = 1; i < chunks.size(); ++i)
+		{
+			auto &temp = aaseries[i];
+			if (j < temp.arrays.size())
+			{
+				points.insert(points.end(), temp.arrays[j].cbegin(), temp.arrays[j].cend());
+				vector<array<T, 2>>().swap(temp.arrays[j]);
+
+				if (aseries.errors[j].empty())
+					aseries.errors[j] = move(temp.errors[j]);
+			}
+		}
+	}
+}
+
+// Compression formats of the inputs, which are detected from their magic bytes
+enum compression_type
+{
+	compression_none,
+	compression_gzip,
+	compression_zstd,
+	compression_xz
+};
+
+const string_view compression_magics[] = {{}, {"\x1F\x8B\x08", 3}, {"\x28\xB5\x2F\xFD", 4}, {"\xFD\x37\x7A\x58\x5A\x00", 6}};
+
+// Get the compression format of data from its magic bytes
+compression_type compression(const string_view &data)
+{
+	for (size_t i = 1; i < size(compression_magics); ++i)
+		if (data.substr(0, compression_magics[i].size()) == compression_magics[i])
+			return static_cast<compression_type>(i);
+
+	return compression_none;
+}
+
+// The decompression libraries are loaded at runtime, so that they are only required to read compressed inputs
+// Only the parts of their stable C interfaces that are used are declared.
+void *load(const char *const library)
+{
+	void *const handle = dlopen(library, RTLD_NOW | RTLD_LOCAL);
+	if (!handle)
+		cerr << "Error: Unable to load the " << library << " library to decompress the input (" << dlerror() << ").\n";
+
+	return handle;
+}
+
+template <typename T>
+bool symbol(void *const handle, const char *const name, T &function)
+{
+	function = reinterpret_cast<T>(dlsym(handle, name));
+	if (!function)
+		cerr << "Error: Unable to load the " << name << " function to decompress the input (" << dlerror() << ").\n";
+
+	return function;
+}
+
+// Each codec decompresses from [in, in + inlen) to [out, out + outlen), advancing both, where finish is true if there is no more input
+// Returns 1 at the end of a stream, 0 to continue or -1 on an error, with the message in error.
+
+// gzip and zlib streams, with zlib
+class gzip_codec
+{
+	// Same layout as in zlib.h
+	struct z_stream
+	{
+		const unsigned char *next_in;
+		unsigned avail_in;
+		unsigned long total_in;
+		unsigned char *next_out;
+		unsigned avail_out;
+		unsigned long total_out;
+		const char *msg;
+		void *state;
+		void *zalloc;
+		void *zfree;
+		void *opaque;
+		int data_type;
+		unsigned long adler;
+		unsigned long reserved;
+	};
+
+	static inline const char *(*zlibVersion)();
+	static inline int (*inflateInit2_)(z_stream *, int, const char *, int);
+	static inline int (*inflate)(z_stream *, int);
+	static inline int (*inflateReset)(z_stream *);
+	static inline int (*inflateEnd)(z_stream *);
+
+	z_stream strm{};
+	bool initialized = false;
+	// A member ended, so the rest of the input is only another member if it starts with the gzip magic bytes
+	bool ended = false;
+	// The rest of the input after the last member (e.g. zero padding), which is ignored like gzip does
+	bool trailing = false;
+
+public:
+	static bool load()
+	{
+		static const bool loaded = []
+		{
+			void *const handle = ::load("libz.so.1");
+			return handle and symbol(handle, "zlibVersion", zlibVersion) and symbol(handle, "inflateInit2_", inflateInit2_) and symbol(handle, "inflate", inflate) and symbol(handle, "inflateReset", inflateReset) and symbol(handle, "inflateEnd", inflateEnd);
+		}();
+		return loaded;
+	}
+
+	~gzip_codec()
+	{
+		if (initialized)
+			inflateEnd(&strm);
+	}
+
+	int decompress(const char *&in, size_t &inlen, char *&out, size_t &outlen, bool, string &error)
+	{
+		if (ended and inlen)
+		{
+			trailing = static_cast<unsigned char>(in[0]) != 0x1F or (inlen > 1 and static_cast<unsigned char>(in[1]) != 0x8B);
+			ended = false;
+		}
+		if (trailing)
+		{
+			in += inlen;
+			inlen = 0;
+			return 1;
+		}
+
+		// Detect the gzip or zlib header
+		if (!initialized and inflateInit2_(&strm, 15 + 32, zlibVersion(), sizeof(strm)))
+		{
+			error = "inflateInit2";
+			return -1;
+		}
+		initialized = true;
+
+		strm.next_in = reinterpret_cast<const unsigned char *>(in);
+		strm.avail_in = min(inlen, size_t(UINT_MAX));
+		strm.next_out = reinterpret_cast<unsigned char *>(out);
+		strm.avail_out = min(outlen, size_t(UINT_MAX));
+
+		const int code = inflate(&strm, 0);
+
+		const size_t used = reinterpret_cast<const char *>(strm.next_in) - in;
+		const size_t written = reinterpret_cast<char *>(strm.next_out) - out;
+		in += used;
+		inlen -= used;
+		out += written;
+		outlen -= written;
+
+		// No progress (Z_BUF_ERROR) is not an error by itself
+		if (code == 0 or code == -5)
+			return 0;
+		// The input can have multiple gzip members
+		if (code == 1)
+		{
+			inflateReset(&strm);
+			ended = true;
+			return 1;
+		}
+
+		error = strm.msg ? strm.msg : "inflate";
+		return -1;
+	}
+};
+
+// zstd streams, with libzstd
+class zstd_codec
+{
+	// Same layout as in zstd.h
+	struct ZSTD_inBuffer
+	{
+		const void *src;
+		size_t size;
+		size_t pos;
+	};
+
+	struct ZSTD_outBuffer
+	{
+		void *dst;
+		size_t size;
+		size_t pos;
+	};
+
+	static inline void *(*ZSTD_createDStream)();
+	static inline size_t (*ZSTD_freeDStream)(void *);
+	static inline size_t (*ZSTD_decompressStream)(void *, ZSTD_outBuffer *, ZSTD_inBuffer *);
+	static inline unsigned (*ZSTD_isError)(size_t);
+	static inline const char *(*ZSTD_getErrorName)(size_t);
+
+	void *const dstream = ZSTD_createDStream();
+
+public:
+	static bool load()
+	{
+		static const bool loaded = []
+		{
+			void *const handle = ::load("libzstd.so.1");
+			return handle and symbol(handle, "ZSTD_createDStream", ZSTD_createDStream) and symbol(handle, "ZSTD_freeDStream", ZSTD_freeDStream) and symbol(handle, "ZSTD_decompressStream", ZSTD_decompressStream) and symbol(handle, "ZSTD_isError", ZSTD_isError) and symbol(handle, "ZSTD_getErrorName", ZSTD_getErrorName);
+		}();
+		return loaded;
+	}
+
+	~zstd_codec() { ZSTD_freeDStream(dstream); }
+
+	int decompress(const char *&in, size_t &inlen, char *&out, size_t &outlen, bool, string &error)
+	{
+		if (!dstream)
+		{
+			error = "ZSTD_createDStream";
+			return -1;
+		}
+
+		ZSTD_inBuffer input = {in, inlen, 0};
+		ZSTD_outBuffer output = {out, outlen, 0};
+
+		// The next frame is started automatically
+		const size_t code = ZSTD_decompressStream(dstream, &output, &input);
+
+		in += input.pos;
+		inlen -= input.pos;
+		out += output.pos;
+		outlen -= output.pos;
+
+		if (ZSTD_isError(code))
+		{
+			error = ZSTD_getErrorName(code);
+			return -1;
+		}
+
+		// The frame has been completely decompressed and output
+		return !code;
+	}
+};
+
+// xz streams, with liblzma
+class xz_codec
+{
+	// Same layout as in lzma/base.h
+	struct lzma_stream
+	{
+		const uint8_t *next_in;
+		size_t avail_in;
+		uint64_t total_in;
+		uint8_t *next_out;
+		size_t avail_out;
+		uint64_t total_out;
+		const void *allocator;
+		void *internal;
+		void *reserved_ptr1;
+		void *reserved_ptr2;
+		void *reserved_ptr3;
+		void *reserved_ptr4;
+		uint64_t seek_pos;
+		uint64_t reserved_int2;
+		size_t reserved_int3;
+		size_t reserved_int4;
+		int reserved_enum1;
+		int reserved_enum2;
+	};
+
+	static inline int (*lzma_stream_decoder)(lzma_stream *, uint64_t, uint32_t);
+	static inline int (*lzma_code)(lzma_stream *, int);
+	static inline void (*lzma_end)(lzma_stream *);
+
+	lzma_stream strm{};
+	bool initialized = false;
+
+public:
+	static bool load()
+	{
+		static const bool loaded = []
+		{
+			void *const handle = ::load("liblzma.so.5");
+			return handle and symbol(handle, "lzma_stream_decoder", lzma_stream_decoder) and symbol(handle, "lzma_code", lzma_code) and symbol(handle, "lzma_end", lzma_end);
+		}();
+		return loaded;
+	}
+
+	~xz_codec()
+	{
+		if (initialized)
+			lzma_end(&strm);
+	}
+
+	int decompress(const char *&in, size_t &inlen, char *&out, size_t &outlen, const bool finish, string &error)
+	{
+		// No memory limit and LZMA_CONCATENATED, so that the input can have multiple xz streams
+		if (!initialized and lzma_stream_decoder(&strm, UINT64_MAX, 0x08))
+		{
+			error = "lzma_stream_decoder";
+			return -1;
+		}
+		initialized = true;
+
+		strm.next_in = reinterpret_cast<const uint8_t *>(in);
+		strm.avail_in = inlen;
+		strm.next_out = reinterpret_cast<uint8_t *>(out);
+		strm.avail_out = outlen;
+
+		// LZMA_RUN or LZMA_FINISH
+		const int code = lzma_code(&strm, finish ? 3 : 0);
+
+		const size_t used = reinterpret_cast<const char *>(strm.next_in) - in;
+		const size_t written = reinterpret_cast<char *>(strm.next_out) - out;
+		in += used;
+		inlen -= used;
+		out += written;
+		outlen -= written;
+
+		// No progress (LZMA_BUF_ERROR) is not an error by itself
+		if (code == 0 or code == 10)
+			return 0;
+		if (code == 1)
+			return 1;
+
+		error = "lzma_code error " + to_string(code);
+		return -1;
+	}
+};
+
+// Decompresses an input on its own thread, so that it overlaps with parsing
+// The decompressed blocks are passed through a queue of up to four blocks, so it uses a constant amount of memory.
+class decompressor
+{
+	static constexpr size_t block_size = 1 << 20;
+	static constexpr size_t queue_size = 4;
+
+	const int fd;
+	// Start of the input, which was already read to detect the compression format
+	string prefix;
+
+	mutex amutex;
+	condition_variable ready;
+	condition_variable space;
+	deque<string> blocks;
+	bool done = false;
+	bool stopped = false;
+	// The input could not be read or decompressed, so the blocks are only the start of it
+	bool failed = false;
+
+	thread athread;
+
+	bool push(string &&block)
+	{
+		unique_lock<mutex> lock(amutex);
+		space.wait(lock, [&]
+				   { return blocks.size() < queue_size or stopped; });
+		if (stopped)
+			return false;
+		blocks.push_back(move(block));
+		ready.notify_one();
+		return true;
+	}
+
+	// Decompress the input, returns false if it could not be read or decompressed
+	template <typename C>
+	bool run()
+	{
+		if (!C::load())
+			return false;
+
+		C acodec;
+		string error;
+
+		string input = move(prefix);
+		const char *in = input.data();
+		size_t inlen = input.size();
+		bool eof = false;
+
+		string block(block_size, '\0');
+		size_t size = 0;
+		// The last stream ended, with no more output since
+		bool end = false;
+		bool success = true;
+
+		for (;;)
+		{
+			if (!inlen and !eof)
+			{
+				input.resize(block_size);
+				const ssize_t n = read(fd, input.data(), input.size());
+				if (n == -1 and errno == EINTR)
+					continue;
+				if (n == -1)
+				{
+					cerr << "Error: Unable to read the input (" << strerror(errno) << ").\n";
+					success = false;
+					break;
+				}
+				in = input.data();
+				inlen = n;
+				eof = !n;
+			}
+
+			char *out = block.data() + size;
+			size_t outlen = block.size() - size;
+			const size_t before = inlen;
+			const int code = acodec.decompress(in, inlen, out, outlen, eof, error);
+			const bool progress = inlen != before or out != block.data() + size;
+			size = out - block.data();
+
+			if (code == -1)
+			{
+				cerr << "Error: Unable to decompress the input (" << error << ").\n";
+				success = false;
+				break;
+			}
+			if (code == 1 or progress)
+				end = code == 1;
+
+			if (size == block.size())
+			{
+				if (!push(move(block)))
+					return true;
+				block.assign(block_size, '\0');
+				size = 0;
+			}
+
+			if (eof and !inlen and (end or !progress))
+			{
+				if (!end)
+				{
+					cerr << "Error: Unable to decompress the input (unexpected end of input).\n";
+					success = false;
+				}
+				break;
+			}
+		}
+
+		// The output so far is used even after an error, except for its last line, which could be incomplete
+		block.resize(size);
+		if (!block.empty())
+			push(move(block));
+		return success;
+	}
+
+public:
+	decompressor(const int fd, const compression_type type, string prefix) : fd(fd), prefix(move(prefix))
+	{
+		athread = thread([this, type]
+						 {
+			bool success = false;
+			if (type == compression_gzip)
+				success = run<gzip_codec>();
+			else if (type == compression_zstd)
+				success = run<zstd_codec>();
+			else if (type == compression_xz)
+				success = run<xz_codec>();
+
+			lock_guard<mutex> lock(amutex);
+			failed = !success;
+			done = true;
+			ready.notify_one(); });
+	}
+
+	~decompressor()
+	{
+		{
+			lock_guard<mutex> lock(amutex);
+			stopped = true;
+			space.notify_one();
+		}
+		athread.join();
+	}
+
+	// Get the next decompressed block
+	// Returns 1, 0 at the end of the input or -1 after the last block if the input could not be decompressed.
+	int pop(string &block)
+	{
+		unique_lock<mutex> lock(amutex);
+		ready.wait(lock, [&]
+				   { return !blocks.empty() or done; });
+		if (blocks.empty())
+			return failed ? -1 : 0;
+		block = move(blocks.front());
+		blocks.pop_front();
+		space.notify_one();
+		return 1;
+	}
+};
+
+// Input from a file descriptor, which is decompressed on its own thread if it starts with the magic bytes of a gzip, zstd or xz stream
+class reader
+{
+	const int fd;
+	// Bytes read to detect the compression format
+	string prefix;
+	unique_ptr<decompressor> adecompressor;
+	string block;
+	size_t pos = 0;
+
+public:
+	explicit reader(const int fd) : fd(fd)
+	{
+		// Only read as many bytes as could be the start of a magic, so that reading a stream (e.g. a pipe) does not wait for more input than needed
+		for (;;)
+		{
+			bool partial = false;
+			for (const auto &magic : compression_magics)
+				if (prefix.size() < magic.size() and magic.substr(0, prefix.size()) == prefix)
+					partial = true;
+			if (!partial)
+				break;
+
+			char c;
+			const ssize_t n = ::read(fd, &c, 1);
+			if (n == -1 and errno == EINTR)
+				continue;
+			if (n <= 0)
+				break;
+			prefix += c;
+		}
+
+		const compression_type type = compression(prefix);
+		if (type != compression_none)
+		{
+			adecompressor = make_unique<decompressor>(fd, type, move(prefix));
+			prefix.clear();
+		}
+		block = move(prefix);
+	}
+
+	// Read up to size bytes into data, like read()
+	// Returns the number of bytes read, 0 at the end of the input or -1 on an error, which is output and sets readerror, except for EINTR.
+	ssize_t read(char *const data, const size_t size)
+	{
+		while (pos == block.size())
+		{
+			if (!adecompressor)
+			{
+				const ssize_t n = ::read(fd, data, size);
+				if (n == -1 and errno != EINTR)
+				{
+					cerr << "Error: Unable to read the input (" << strerror(errno) << ").\n";
+					readerror = true;
+				}
+				return n;
+			}
+			const int code = adecompressor->pop(block);
+			if (code == -1)
+			{
+				readerror = true;
+				errno = EIO;
+				return -1;
+			}
+			if (!code)
+				return 0;
+			pos = 0;
+		}
+
+		const size_t n = min(size, block.size() - pos);
+		memcpy(data, block.data() + pos, n);
+		pos += n;
+		return n;
+	}
+};
+
+// Map the rest of a regular file into memory, from the current file offset
+// Returns false if the file is not a regular file (e.g. a pipe) or it is compressed, which must then be read as a stream instead. The mapping is never unmapped.
+bool mapfile(const int fd, string_view &buffer)
+{
+	struct stat st;
+	if (fstat(fd, &st) == -1 or !S_ISREG(st.st_mode))
+		return false;
+
+	const off_t offset = lseek(fd, 0, SEEK_CUR);
+	if (offset == -1)
+		return false;
+
+	buffer = {};
+	if (offset >= st.st_size)
+		return true;
+
+	void *const addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (addr == MAP_FAILED)
+		return false;
+
+	buffer = {static_cast<const char *>(addr) + offset, static_cast<size_t>(st.st_size - offset)};
+
+	if (compression(buffer) != compression_none)
+	{
+		munmap(addr, st.st_size);
+		return false;
+	}
+
+	bytesread += buffer.size();
+
+	// Consume the file, as if it had been read
+	lseek(fd, 0, SEEK_END);
+
+	return true;
+}
+
+// Read a stream (e.g. a pipe) in blocks, calling function(buffer) with the whole lines of each block as they are read, then with the rest
+// A compressed input is decompressed on another thread, so that it overlaps with parsing. The first row is always kept if header is true. Reading stops once there are no rows left with --head. With --tail, only the text of the last rows read so far is kept, which function is called with at the end.
+template <typename F>
+void readlines(const int fd, const char line_delim, const bool header, limits alimits, const F &function)
+{
+	const size_t block = 1 << 20;
+
+	reader areader(fd);
+	string buffer;
+	size_t size = 0;
+	string last;
+	const bool tail = alimits.tail != SIZE_MAX;
+	alimits.first = header ? 1 : 0;
+
+	// Use the rows of a buffer of whole lines that are within the limits
+	auto use = [&](const string_view &abuffer)
+	{
+		const size_t first = headrows(abuffer, 0, alimits.first, line_delim);
+		const size_t end = headrows(abuffer, first, alimits.head, line_delim);
+		if (!tail)
+		{
+			function(abuffer.substr(0, end));
+			return;
+		}
+
+		if (first)
+			function(abuffer.substr(0, first));
+		last.append(abuffer, first, end - first);
+		last.erase(0, tailrows(last, alimits.tail, line_delim));
+	};
+
+	while (alimits.first or alimits.head)
+	{
+		buffer.resize(size + block);
+		const ssize_t n = areader.read(buffer.data() + size, block);
+		if (n == -1 and errno == EINTR)
+			continue;
+
+		// The rest of the input is not used if it could not be read, since its last line could be incomplete
+		if (n == -1)
+			return;
+
+		if (!n)
+		{
+			use(string_view(buffer.data(), size));
+			break;
+		}
+
+		size += n;
+		bytesread += n;
+
+		const size_t end = string_view(buffer.data(), size).rfind(line_delim);
+		if (end != string_view::npos)
+		{
+			use(string_view(buffer.data(), end + 1));
+			buffer.erase(0, end + 1);
+			size -= end + 1;
+		}
+	}
+
+	if (tail)
+		function(string_view(last));
+}
+
+// Read a stream, parsing the whole lines of each block as they are read
+template <typename T, typename F>
+void input(const int fd, const delimiters &adelimiters, const bool single, bool header, limits alimits, series<T> &aseries, const F &convert)
+{
+	size_t line = 0;
+
+	readlines(fd, adelimiters.line_delim, header, alimits, [&](const string_view &buffer)
+			  { line = parse(buffer, adelimiters, single, line, header, aseries, convert); });
+}
+
+// Get a little-endian number of type S
+template <typename S>
+S load(const char *const data)
+{
+	using U = conditional_t<sizeof(S) == 8, uint64_t, uint32_t>;
+
+	U value;
+	memcpy(&value, data, sizeof(value));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	if constexpr (sizeof(S) == 8)
+		value = __builtin_bswap64(value);
+	else
+		value = __builtin_bswap32(value);
+#endif
+
+	S number;
+	memcpy(&number, &value, sizeof(number));
+	return number;
+}
+
+// Convert the records of packed little-endian numbers of type S into the points of the series, starting with record first
+// Each record has columns numbers, of which only the selected fields are used. The first is the x value, unless index is set, then the x value is the number of the record.
+template <typename S, typename T>
+void decode(const string_view &buffer, const size_t columns, const selection &fields, const bool index, const bool single, const size_t first, series<T> &aseries, const unsigned jobs)
+{
+	const size_t size = columns * sizeof(S);
+	const size_t records = buffer.size() / size;
+
+	// Offsets of the numbers that are used in each record
+	vector<size_t> offsets;
+	for (size_t j = 0; j < columns; ++j)
+		if (fields[j])
+			offsets.push_back(j * sizeof(S));
+
+	const size_t used = offsets.size();
+	const size_t y = index ? 0 : 1;
+	const size_t n = single ? std::max(used, y + 1) - y : 1;
+
+	if (aseries.arrays.size() < n)
+	{
+		aseries.arrays.resize(n);
+		aseries.errors.resize(n);
+	}
+
+	const size_t start = aseries.arrays[0].size();
+	for (auto &points : aseries.arrays)
+		points.resize(start + records);
+
+	aseries.rows += records;
+	aseries.cells += records * used;
+	aseries.minwidth = min(aseries.minwidth, used + (index ? 1 : 0));
+	aseries.maxwidth = max(aseries.maxwidth, used + (index ? 1 : 0));
+
+	// The records are independent, so they are converted in blocks on separate threads
+	const size_t block = 1 << 16;
+
+	parallel((records + block - 1) / block, jobs, [&](const size_t k)
+			 {
+		for (size_t i = k * block; i < min((k + 1) * block, records); ++i)
+		{
+			const char *const record = buffer.data() + (i * size);
+			const T x = index ? static_cast<T>(first + i) : used ? static_cast<T>(load<S>(record + offsets[0])) : T(0);
+
+			for (size_t j = 0; j < n; ++j)
+				aseries.arrays[j][start + i] = {x, y + j < used ? static_cast<T>(load<S>(record + offsets[y + j])) : T(0)};
+		} });
+}
+
+// Convert the records of a buffer in the binary format
+// Returns the number of bytes used, which is a whole number of records.
+template <typename T>
+size_t decode(const string_view &buffer, const format_type format, const size_t columns, const selection &fields, const bool index, const bool single, const size_t first, series<T> &aseries, const unsigned jobs)
+{
+	switch (format)
+	{
+	case format_f64le:
+		decode<double>(buffer, columns, fields, index, single, first, aseries, jobs);
+		break;
+	case format_f32le:
+		decode<float>(buffer, columns, fields, index, single, first, aseries, jobs);
+		break;
+	case format_i64le:
+		decode<int64_t>(buffer, columns, fields, index, single, first, aseries, jobs);
+		break;
+	case format_i32le:
+		decode<int32_t>(buffer, columns, fields, index, single, first, aseries, jobs);
+		break;
+	default:
+		abort();
+	}
+
+	const size_t size = columns * format_sizes[format];
+	return buffer.size() - (buffer.size() % size);
+}
+
+// Read a file or stream in a binary format, without any parsing
+// Only the records that are kept with the --head and --tail limits are converted. Returns false if there is a partial record at the end.
+template <typename T>
+bool input(const int fd, const format_type format, const size_t columns, const selection &fields, const bool index, const bool single, limits alimits, series<T> &aseries, const unsigned jobs)
+{
+	const size_t size = columns * format_sizes[format];
+
+	string_view buffer;
+	if (mapfile(fd, buffer))
+	{
+		const size_t records = buffer.size() / size;
+		const size_t end = min(records, alimits.head);
+		const size_t start = end - min(end, alimits.tail);
+		decode(buffer.substr(start * size, (end - start) * size), format, columns, fields, index, single, start, aseries, jobs);
+		return end < records or !(buffer.size() % size);
+	}
+
+	const size_t block = 1 << 20;
+
+	reader areader(fd);
+	string abuffer;
+	size_t asize = 0;
+	size_t first = 0;
+	// With --tail, the last records read so far, which are converted at the end, and the number of the first one
+	string last;
+	size_t lastfirst = 0;
+	const bool tail = alimits.tail != SIZE_MAX;
+
+	while (alimits.head)
+	{
+		abuffer.resize(asize + block);
+		const ssize_t n = areader.read(abuffer.data() + asize, block);
+		if (n == -1 and errno == EINTR)
+			continue;
+
+		// The error was already output
+		if (n == -1)
+			return true;
+
+		if (!n)
+			break;
+
+		asize += n;
+		bytesread += n;
+
+		const size_t records = min(asize / size, alimits.head);
+		const size_t used = records * size;
+		alimits.head -= records;
+
+		if (tail)
+		{
+			last.append(abuffer, 0, used);
+			const size_t lastrecords = last.size() / size;
+			const size_t skip = lastrecords - min(lastrecords, alimits.tail);
+			last.erase(0, skip * size);
+			lastfirst += skip;
+		}
+		else
+			decode(string_view(abuffer.data(), used), format, columns, fields, index, single, first, aseries, jobs);
+
+		first += records;
+		abuffer.erase(0, used);
+		asize -= used;
+	}
+
+	if (tail)
+		decode(string_view(last), format, columns, fields, index, single, lastfirst, aseries, jobs);
+
+	return !asize or !alimits.head;
+}
+
+// Convert a field to a number
+template <typename T>
+bool tonumber(const char *const token, T &number, const int frombase, ostream &err)
+{
+	if constexpr (is_integral_v<T>)
+	{
+		char *p;
+		number = strtoimax(token, &p, frombase);
+		if (*p)
+		{
+			err << "Warning: Invalid integer number: " << quoted(token) << ".\n";
+			return false;
+		}
+		if (errno == ERANGE)
+		{
+			err << "Warning: Integer number too large to input: " << quoted(token) << " (" << strerror(errno) << ").\n";
+			return false;
+		}
+	}
+	else
+	{
+		char *p;
+		number = strtold(token, &p);
+		if (*p)
+		{
+			err << "Warning: Invalid floating point number: " << quoted(token) << ".\n";
+			return false;
+		}
+		if (errno == ERANGE)
+		{
+			err << "Warning: Floating point number too large to input: " << quoted(token) << " (" << strerror(errno) << ").\n";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Minimum and maximum x and y values of a sliding window of points
+// Uses monotonic queues, so that they only need to be updated when a point enters or leaves the window.
+template <typename T>
+class window
+{
+	size_t first = 0;
+	size_t last = 0;
+	deque<pair<T, size_t>> mins[2];
+	deque<pair<T, size_t>> maxs[2];
+
+public:
+	void push(const array<T, 2> &point)
+	{
+		for (size_t i = 0; i < 2; ++i)
+		{
+			while (!mins[i].empty() and !(mins[i].back().first < point[i]))
+				mins[i].pop_back();
+			mins[i].emplace_back(point[i], last);
+
+			while (!maxs[i].empty() and !(point[i] < maxs[i].back().first))
+				maxs[i].pop_back();
+			maxs[i].emplace_back(point[i], last);
+		}
+
+		++last;
+	}
+
+	void pop()
+	{
+		for (size_t i = 0; i < 2; ++i)
+		{
+			if (mins[i].front().second == first)
+				mins[i].pop_front();
+			if (maxs[i].front().second == first)
+				maxs[i].pop_front();
+		}
+
+		++first;
+	}
+
+	T min(const size_t i) const { return mins[i].front().first; }
+	T max(const size_t i) const { return maxs[i].front().first; }
+};
+
+// Convert a field to a number with from_chars(), which is locale independent and much faster than strtold()
+// Accepts the same leading whitespace, sign and prefixes as strtoimax() with base 0 and strtold(), including hexadecimal floating point numbers.
+template <typename T>
+bool fromchars(const string_view &token, T &number, const size_t line, ostream &err)
+{
+	const char *first = token.data();
+	const char *const last = first + token.size();
+
+	// Same characters as isspace() in the "C" locale
+	while (first != last and (*first == ' ' or (*first >= '\t' and *first <= '\r')))
+		++first;
+
+	const bool negative = first != last and *first == '-';
+	if (first != last and (*first == '-' or *first == '+'))
+		++first;
+
+	// from_chars() would accept a second minus sign
+	if (first != last and (*first == '-' or *first == '+'))
+	{
+		err << "Warning: Invalid " << (is_integral_v<T> ? "integer" : "floating point") << " number on line " << line << ": " << quoted(token) << ".\n";
+		return false;
+	}
+
+	const bool hex = last - first > 2 and *first == '0' and (first[1] == 'x' or first[1] == 'X');
+
+	// Nor a sign after the prefix
+	if (hex and (first[2] == '-' or first[2] == '+'))
+	{
+		err << "Warning: Invalid " << (is_integral_v<T> ? "integer" : "floating point") << " number on line " << line << ": " << quoted(token) << ".\n";
+		return false;
+	}
+
+	from_chars_result result;
+	bool range = false;
+	if constexpr (is_integral_v<T>)
+	{
+		int base = 10;
+		if (hex)
+		{
+			base = 16;
+			first += 2;
+		}
+		else if (last - first > 1 and *first == '0')
+		{
+			base = 8;
+			++first;
+		}
+
+		uintmax_t value = 0;
+		result = from_chars(first, last, value, base);
+		range = result.ec == errc::result_out_of_range or value > (negative ? static_cast<uintmax_t>(INTMAX_MAX) + 1 : INTMAX_MAX);
+		number = negative ? static_cast<T>(0 - value) : static_cast<T>(value);
+	}
+	else
+	{
+		if (hex)
+			first += 2;
+
+		result = from_chars(first, last, number, hex ? chars_format::hex : chars_format::general);
+		range = result.ec == errc::result_out_of_range;
+		if (negative)
+			number = -number;
+	}
+
+	if (first == last or (result.ec != errc() and !range) or result.ptr != last)
+	{
+		err << "Warning: Invalid " << (is_integral_v<T> ? "integer" : "floating point") << " number on line " << line << ": " << quoted(token) << ".\n";
+		return false;
+	}
+	if (range)
+	{
+		err << "Warning: " << (is_integral_v<T> ? "Integer" : "Floating point") << " number too large to input on line " << line << ": " << quoted(token) << " (" << make_error_code(errc::result_out_of_range).message() << ").\n";
+		return false;
+	}
+
+	return true;
+}
+
+// Reduce a series with far more points than the graph has dots, keeping the order of the points
+// Only the first points with the minimum and maximum x and y values in each cell of the grid are kept, which light the same dots as all of the points in the cell. The points with the minimum and maximum x and y values of the whole series are also kept, so that the range of the graph does not change.
+template <typename T>
+void decimate(vector<array<T, 2>> &points, const size_t columns, const size_t rows, const long double xmin, const long double xmax, const long double ymin, const long double ymax)
+{
+	const size_t cells = columns * rows;
+	if (points.size() <= cells * 4)
+		return;
+
+	const long double xstep = (xmax - xmin) / columns;
+	const long double ystep = (ymax - ymin) / rows;
+
+	// Index of the points with the minimum x, maximum x, minimum y and maximum y of each cell, then of the series
+	vector<array<size_t, 4>> indices(cells + 1, {SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX});
+
+	auto update = [&points](array<size_t, 4> &index, const size_t i)
+	{
+		for (size_t k = 0; k < 2; ++k)
+		{
+			if (index[k * 2] == SIZE_MAX or points[i][k] < points[index[k * 2]][k])
+				index[k * 2] = i;
+			if (index[k * 2 + 1] == SIZE_MAX or points[index[k * 2 + 1]][k] < points[i][k])
+				index[k * 2 + 1] = i;
+		}
+	};
+
+	vector<bool> keep(points.size());
+
+	for (size_t i = 0; i < points.size(); ++i)
+	{
+		const auto &[x, y] = points[i];
+
+		// Not a number
+		if (!(x == x) or !(y == y))
+		{
+			keep[i] = true;
+			continue;
+		}
+
+		update(indices[cells], i);
+
+		if (x >= xmin and x <= xmax and y >= ymin and y <= ymax)
+		{
+			const size_t column = xstep > 0 ? min(static_cast<size_t>((x - xmin) / xstep), columns - 1) : 0;
+			const size_t row = ystep > 0 ? min(static_cast<size_t>((y - ymin) / ystep), rows - 1) : 0;
+			update(indices[(row * columns) + column], i);
+		}
+	}
+
+	for (const auto &index : indices)
+		for (const size_t i : index)
+			if (i != SIZE_MAX)
+				keep[i] = true;
+
+	size_t j = 0;
+	for (size_t i = 0; i < points.size(); ++i)
+		if (keep[i])
+			points[j++] = points[i];
+
+	points.resize(j);
+	points.shrink_to_fit();
+}
+
+// Output usage
+void usage(const char *const programname)
+{
+	cerr << "Usage:  " << programname << R"( [OPTION(S)]... [FILE(S)]...
+or:     )"
+		 << programname << R"d( <OPTION>
+Convert input into a graph/plot. With no FILE, or when FILE is -, read from standard input. Input compressed with gzip, zstd or xz is decompressed automatically. Empty lines are ignored. With a single input, each row can have one or more columns in the form 'x y1 ... yn', which will be converted to 'x y1' ... 'x yn'. With a single input and column it will output a histogram, otherwise it will output a plot. With multiple inputs, rows should have exactly two columns in the form 'x y'. See examples below.
+
+Options:
+    Mandatory arguments to long options are mandatory for short options too.
+    -t, --title <TITLE>     Graph Name/Title
+        --name <TITLE>          Show a title above the graph. The title is word wrapped based on the current width of the terminal.
+    -h, --height <HEIGHT>   Graph height (default 0)
+                                If HEIGHT is 0, it will be set to the current height of the terminal (number of rows).
+    -w, --width <WIDTH>     Graph width (default 0)
+                                If WIDTH is 0, it will be set to the current width of the terminal (number of columns).
+    -x, --x-min <XMIN>      Minimum x value (default 0)
+                                If XMIN and XMAX are both 0, they will be set to the respective minimum and maximum values of x in the input.
+    -X, --x-max <XMAX>      Maximum x value (default 0)
+                                If XMIN and XMAX are both 0, they will be set to the respective minimum and maximum values of x in the input.
+    -y, --y-min <YMIN>      Minimum y value (default 0)
+                                If YMIN and YMAX are both 0, they will be set to the respective minimum and maximum values of y in the input.
+    -Y, --y-max <YMAX>      Maximum y value (default 0)
+                                If YMIN and YMAX are both 0, they will be set to the respective minimum and maximum values of y in the input.
+    -C, --type <TYPE>       Type (default 'braille')
+                                <TYPE> can be:
+                                    braille:                  Braille (default)
+                                    block:                    Block
+                                    block-quadrant:           Block quadrant
+                                    separated-block-quadrant: Separated block quadrant
+                                    block-sextant:            Block sextant
+                                    separated-block-sextant:  Separated block sextant
+                                    block-octant:             Block octant
+    -m, --mark <MARK>       Mark type (default 'dot')
+                                <MARK> can be:
+                                    dot:            Dot (default)
+                                    plus:           Plus
+                                    square:         Square
+    -b, --border            Border
+                                Show graph and legend border.
+    -a, --no-axis           No axis
+                                Do not show the axis. Implies --no-axis-labels, --no-ticks and --no-units-labels.
+    -l, --no-axis-labels    No axis labels
+    -T, --no-ticks          No axis tick marks
+                                Implies --no-units-labels.
+    -u, --no-units-labels   No axis units labels
+        --x-units <UNIT>    X-axis units format (default 'fracts')
+                                See UNIT below.
+        --y-units <UNIT>    Y-axis units format (default 'fracts')
+                                See UNIT below.
+    -n, --names <NAMES>     Series names
+                                Provide either a comma separated list of names or specify this option multiple times, once for each input/series.
+    -L, --legend            Legend
+                                Show a legend below the graph. Uses the --names values or the first line/row of each input if that options is not provided.
+    -s, --separator <SEP>   Characters to delimit columns/fields (default any whitespace)
+    -d, --delimiter <SEP>   
+        --csv               Comma separated values (CSV)
+                                Fields can be quoted with double quotes ("), so that they can contain the separators and escaped double quotes (""), as in RFC 4180. Lines can end with a carriage return. Use --separator to change the separator.
+        --tsv               Tab separated values (TSV)
+                                Same as --csv, but the default separator is a tab.
+        --fields <LIST>     Fields to use
+                                Only use the selected fields (columns) of each line, the others are skipped without being stored. Provide a comma separated list of fields and ranges of fields, numbered from 1, as in cut -f (e.g. 1,3,7-9 or 5-). The fields are used in the order of the input, so the first is the x value. Also selects the numbers of each record of the binary formats.
+        --head <ROWS>       Only use the first ROWS rows of each input
+                                Reading stops once they have been read. With --legend, the header row is always kept and not counted. Also applies to the records of the binary formats. Not supported with --follow.
+        --tail <ROWS>       Only use the last ROWS rows of each input
+                                Only the last rows are kept while reading and regular files are searched backwards from the end. Otherwise the same as --head. With both, the last rows of the first rows are used.
+    -z, --zero-terminated   Line delimiter is NUL, not newline
+    -j, --jobs <JOBS>       Number of threads (default 0)
+                                Read and convert up to JOBS inputs/series at the same time. If JOBS is 0, it will be set to the number of processor cores.
+    -i, --int               Integer numbers
+                                Read input values as integer numbers. Supports all Integer numbers )d"
+		 << INTMAX_MIN << " - " << INTMAX_MAX << R"d(.
+    -f, --float             Floating point numbers (default)
+                                Read input values as floating point numbers. Supports all Floating point numbers )d"
+		 << LDBL_MIN << " - " << LDBL_MAX << R"d(.
+        --follow            Follow the inputs
+                                Keep reading the inputs after the first plot, like 'tail -f', and redraw the plot in place every INTERVAL seconds. Only plots are supported.
+        --points <POINTS>   Number of points to keep of each series with --follow (default 1000)
+                                If POINTS is 0, the number of points is not limited.
+        --span <SPAN>       Range of x values to keep of each series with --follow (default 0)
+                                Only the points within SPAN of the last x value of each series are kept. If SPAN is 0, the range is not limited.
+        --interval <SECONDS> Refresh interval with --follow (default 1)
+        --precision <PRECISION> Floating point precision (default 'long-double')
+                                <PRECISION> can be:
+                                    long-double:    Long double (default)
+                                    double:         Double. Uses a much faster, locale independent, parser for both floating point and integer numbers. Plenty for the resolution of the terminal.
+        --no-decimate       Do not reduce the series before plotting
+                                By default, series with far more points than the graph has dots are reduced to only the points with the minimum and maximum x and y values of each cell of a grid finer than the dots, which draws the same plot much faster.
+        --bins <BINS>       Output a histogram of the first column of the input with BINS bins (default 0)
+                                The values are counted in the bins as they are read, so it uses constant memory for any size of input. If XMIN and XMAX are both 0, a file is read twice, first to find the range, while a stream (e.g. a pipe) starts from the range of its first values, then doubles it as needed. If BINS is 0, all values are kept.
+        --input-format <FORMAT> Format of the input (default 'text')
+                                <FORMAT> can be:
+                                    text:           Text, with a row of values on each line
+                                    f64le:          Binary 64-bit floating point numbers, little-endian
+                                    f32le:          Binary 32-bit floating point numbers, little-endian
+                                    i64le:          Binary 64-bit integer numbers, little-endian
+                                    i32le:          Binary 32-bit integer numbers, little-endian
+                                The binary formats are packed records of COLUMNS numbers each, like the rows of the text format, which are converted without any parsing. Files are memory mapped. Not supported with --follow, --bins or --stats.
+        --binary-columns <COLUMNS> Number of numbers in each record of a binary format (default 2)
+        --index             The x value of each record of a binary format is its index, starting at 0, so every number in the record is a y value
+        --stats             Output summary statistics of each series instead
+                                Outputs a table with the count, minimum, maximum, mean, standard deviation and 50th, 90th, 99th and 99.9th percentiles of the y values of each series, or of the values of a histogram. The values are summarized as they are read, so it uses bounded memory.
+        --profile[=FORMAT]  Output a profile of the run to standard error
+                                Outputs the time of each phase: setlocale, option parsing, opening, input (reading, tokenizing and numeric conversion), range finding, rendering and the final write. Also outputs the number of bytes read, rows, cells and heap allocations and the peak resident set size. <FORMAT> can be: text (default), json.
+    -S, --style <STYLE>     Border style (default 'light')
+                                <STYLE> can be:
+                                    ascii:          ASCII
+                                    basic:          Basic
+                                    light:          Light (default)
+                                    heavy:          Heavy
+                                    double:         Double
+                                    arc:            Light Arc
+                                    light-dashed:   Light Dashed
+                                    heavy-dashed:   Heavy Dashed
+    -c, --color <COLOR>     Graph/Plot color (default 'red')
+                                Used only when plotting a single input/series. Otherwise, colors red - bright white (2 - 16) are used inorder. The system default color is used where the plots cross. <COLOR> can be:
+                                    default:        System default
+                                    black:          Black
+                                    red:            Red (default)
+                                    green:          Green
+                                    yellow:         Yellow
+                                    blue:           Blue
+                                    magenta:        Magenta
+                                    cyan:           Cyan
+                                    white:          White
+                                    gray:           Gray
+                                    bright-red:     Bright Red
+                                    bright-green:   Bright Green
+                                    bright-yellow:  Bright Yellow
+                                    bright-blue:    Bright Blue
+                                    bright-magenta: Bright Magenta
+                                    bright-cyan:    Bright Cyan
+                                    bright-white:   Bright White
+
+        --help              Display this help and exit
+        --version           Output version information and exit
+
+UNIT options:
+    number:         Locale number format (similar to 'numfmt --grouping')
+                        e.g. 1234.25 → 1,234.25
+    si:             Auto-scale to the SI standard (similar to 'numfmt --to=si')
+                        e.g. 1000 → 1K
+    iec:            Auto-scale to the IEC standard (similar to 'numfmt --to=iec')
+                        e.g. 1024 → 1K
+    iec-i:          Auto-scale to the IEC standard (similar to 'numfmt --to=iec-i')
+                        e.g. 1024 → 1Ki
+    fracts:         Locale number format, but convert fractions and mathematical constants to Unicode characters (default)
+                        e.g. 1234.25 → 1,234¼
+    percent:        Percentage format
+                        e.g. 0.123 → 12.3%
+    date:           Locale date format (same as 'date +%x')
+                        e.g. 2147483647 → 01/19/2038
+    time:           Locale time format (same as 'date +%X')
+                        e.g. 2147483647 → 03:14:07 AM
+    monetary:       Locale monetary/currency format (does not work with the ‘C’ locale)
+                        e.g. 123 → $1.23
+
+Examples:
+    Output plot
+    $ printf '1 1\n2 2\n3 3\n4 4\n5 5\n6 6\n' | )d"
+		 << programname << R"d( --height 20 --width 40 --x-min -10 --x-max 10 --y-min -10 --y-max 10
+
+    Output plot of single series (Bash Syntax)
+    $ for i in {-20..20}; do echo "$i $(( i + 1 ))"; done | )d"
+		 << programname << R"d( --height 40 --width 80 --x-min -20 --x-max 20 --y-min -20 --y-max 20
+
+    Output plot of multiple series (Bash Syntax)
+    $ for i in {-20..20}; do echo "$i $(( 2 * i )) $(( i ** 2 ))"; done | )d"
+		 << programname << R"d( --height 40 --width 80 --x-min -20 --x-max 20 --y-min -20 --y-max 20
+
+    Output graph of multiple functions
+    $ awk 'BEGIN { pi=atan2(0, -1); width=160; xmin=-(2*pi); xmax=2*pi; xstep=(xmax-xmin)/width; for(i=0; i<width*2; ++i) { x=((i/2)*xstep)+xmin; print x,sin(x),cos(x),sin(x)/cos(x) } }' | )d"
+		 << programname << R"d( --height 40 --width 80 --y-min -4 --y-max 4 --no-units-labels
+
+    Output live plot of the CPU usage, updated every second
+    $ vmstat 1 | awk 'NR > 2 { print NR, $13, $14; fflush() }' | )d"
+		 << programname << R"d( --follow --points 60 --y-min 0 --y-max 100
+
+    Output a plot in each style (Bash syntax)
+    $ for s in ascii basic light heavy double arc light-dashed heavy-dashed; do for i in {0..9}; do echo "$i $(( i + 1 ))"; done | )d"
+		 << programname << R"( --height 20 --width 40 --x-min -10 --x-max 10 --y-min -10 --y-max 10 --style=$s --title "Style: $s"; done
+
+)";
+}
+
+int main(int argc, char *argv[])
+{
+	// Declared first, so that the output is written before it is restored
+	outputbuf aoutputbuf(cout, STDOUT_FILENO);
+	// Then, so that it outputs the profile after everything else has finished
+	profiler aprofiler;
+
+	size_t height = 0;
+	size_t width = 0;
+
+	long double xmin = -0;
 	long double xmax = 0;
 	long double ymin = -0;
 	long double ymax = 0;
@@ -323,16 +2753,38 @@ int main(int argc, char *argv[])
 
 	const char *delimiter = nullptr;
 	char line_delim = '\n';
+	// Default separator of quoted fields with --csv or --tsv
+	const char *quoted_delimiter = nullptr;
+	selection fields;
+	limits alimits;
 
 	vector<string> names;
 	bool legend = false;
 
+	bool follow = false;
+	size_t points = 1000;
+	long double span = 0;
+	long double interval = 1;
+
+	bool decimation = true;
+	size_t nbins = 0;
+	bool stats = false;
+
+	format_type format = format_text;
+	size_t binary_columns = 2;
+	bool index = false;
+
+	unsigned jobs = 0;
+
 	bool integer = false;
+	precision_type precision = precision_long_double;
 	const int frombase = 0;
 	char *p;
 
 	setlocale(LC_ALL, "");
 
+	aprofiler.phase("setlocale");
+
 	// https://stackoverflow.com/a/38646489
 
 	static struct option long_options[] = {
@@ -340,8 +2792,14 @@ int main(int argc, char *argv[])
 		{"name", required_argument, nullptr, 't'},
 		{"separator", required_argument, nullptr, 's'},
 		{"delimiter", required_argument, nullptr, 'd'},
+		{"csv", no_argument, nullptr, CSV_OPTION},
+		{"tsv", no_argument, nullptr, TSV_OPTION},
+		{"fields", required_argument, nullptr, FIELDS_OPTION},
+		{"head", required_argument, nullptr, HEAD_OPTION},
+		{"tail", required_argument, nullptr, TAIL_OPTION},
 		// {"keep-empty-lines", no_argument, NULL, 'L'},
 		{"zero-terminated", no_argument, nullptr, 'z'},
+		{"jobs", required_argument, nullptr, 'j'},
 		{"int", no_argument, nullptr, 'i'},
 		{"float", no_argument, nullptr, 'f'},
 		{"height", required_argument, nullptr, 'h'},
@@ -363,6 +2821,18 @@ int main(int argc, char *argv[])
 		{"legend", no_argument, nullptr, 'L'},
 		{"style", required_argument, nullptr, 'S'},
 		{"color", required_argument, nullptr, 'c'},
+		{"follow", no_argument, nullptr, FOLLOW_OPTION},
+		{"points", required_argument, nullptr, POINTS_OPTION},
+		{"span", required_argument, nullptr, SPAN_OPTION},
+		{"interval", required_argument, nullptr, INTERVAL_OPTION},
+		{"precision", required_argument, nullptr, PRECISION_OPTION},
+		{"no-decimate", no_argument, nullptr, NO_DECIMATE_OPTION},
+		{"bins", required_argument, nullptr, BINS_OPTION},
+		{"stats", no_argument, nullptr, STATS_OPTION},
+		{"profile", optional_argument, nullptr, PROFILE_OPTION},
+		{"input-format", required_argument, nullptr, INPUT_FORMAT_OPTION},
+		{"binary-columns", required_argument, nullptr, BINARY_COLUMNS_OPTION},
+		{"index", no_argument, nullptr, INDEX_OPTION},
 		{"help", no_argument, nullptr, GETOPT_HELP_CHAR},
 		{"version", no_argument, nullptr, GETOPT_VERSION_CHAR},
 		{nullptr, 0, nullptr, 0}};
@@ -370,7 +2840,7 @@ int main(int argc, char *argv[])
 	int option_index = 0;
 	int c = 0;
 
-	while ((c = getopt_long(argc, argv, "abc:d:fg:h:ilm:n:p:s:t:uw:x:y:zC:LS:TX:Y:", long_options, &option_index)) != -1)
+	while ((c = getopt_long(argc, argv, "abc:d:fg:h:ij:lm:n:p:s:t:uw:x:y:zC:LS:TX:Y:", long_options, &option_index)) != -1)
 	{
 		switch (c)
 		{
@@ -402,6 +2872,19 @@ int main(int argc, char *argv[])
 		case 'i':
 			integer = false;
 			break;
+		case 'j':
+			jobs = strtoul(optarg, &p, frombase);
+			if (*p)
+			{
+				cerr << "Usage: <JOBS> is not a valid integer number: " << quoted(optarg) << ".\n";
+				return 1;
+			}
+			if (errno == ERANGE)
+			{
+				cerr << "Error: Integer number for <JOBS> is too large to input: " << quoted(optarg) << " (" << strerror(errno) << ").\n";
+				return 1;
+			}
+			break;
 		case 'l':
 			aoptions.axislabel = false;
 			break;
@@ -501,250 +2984,1229 @@ int main(int argc, char *argv[])
 				cerr << "Error: Floating point number for <YMAX> is too large to input: " << quoted(optarg) << " (" << strerror(errno) << ")\n";
 				return 1;
 			}
-			break;
-		case X_UNITS_OPTION:
-			aoptions.xunits = xargmatch("--x-units", optarg, units_args, size(units_args), graphs::units_types);
-			break;
-		case Y_UNITS_OPTION:
-			aoptions.yunits = xargmatch("--y-units", optarg, units_args, size(units_args), graphs::units_types);
-			break;
-		case GETOPT_HELP_CHAR:
-			usage(argv[0]);
-			return 0;
-		case GETOPT_VERSION_CHAR:
-			cout << "Graph 1.0\n\n";
-			return 0;
-		case '?':
-			cerr << "Try '" << argv[0] << " --help' for more information.\n";
-			return 1;
-		default:
-			abort();
-		}
+			break;
+		case X_UNITS_OPTION:
+			aoptions.xunits = xargmatch("--x-units", optarg, units_args, size(units_args), graphs::units_types);
+			break;
+		case Y_UNITS_OPTION:
+			aoptions.yunits = xargmatch("--y-units", optarg, units_args, size(units_args), graphs::units_types);
+			break;
+		case FOLLOW_OPTION:
+			follow = true;
+			break;
+		case POINTS_OPTION:
+			points = strtoul(optarg, &p, frombase);
+			if (*p)
+			{
+				cerr << "Usage: <POINTS> is not a valid integer number: " << quoted(optarg) << ".\n";
+				return 1;
+			}
+			if (errno == ERANGE)
+			{
+				cerr << "Error: Integer number for <POINTS> is too large to input: " << quoted(optarg) << " (" << strerror(errno) << ").\n";
+				return 1;
+			}
+			break;
+		case SPAN_OPTION:
+			span = strtold(optarg, &p);
+			if (*p)
+			{
+				cerr << "Usage: <SPAN> is not a valid floating point number: " << quoted(optarg) << '\n';
+				return 1;
+			}
+			if (errno == ERANGE)
+			{
+				cerr << "Error: Floating point number for <SPAN> is too large to input: " << quoted(optarg) << " (" << strerror(errno) << ")\n";
+				return 1;
+			}
+			break;
+		case INTERVAL_OPTION:
+			interval = strtold(optarg, &p);
+			if (*p)
+			{
+				cerr << "Usage: <SECONDS> is not a valid floating point number: " << quoted(optarg) << '\n';
+				return 1;
+			}
+			if (errno == ERANGE)
+			{
+				cerr << "Error: Floating point number for <SECONDS> is too large to input: " << quoted(optarg) << " (" << strerror(errno) << ")\n";
+				return 1;
+			}
+			break;
+		case PRECISION_OPTION:
+			precision = xargmatch("--precision", optarg, precision_args, size(precision_args), precision_types);
+			break;
+		case NO_DECIMATE_OPTION:
+			decimation = false;
+			break;
+		case STATS_OPTION:
+			stats = true;
+			break;
+		case PROFILE_OPTION:
+			aprofiler.enabled = true;
+			if (optarg)
+				aprofiler.format = xargmatch("--profile", optarg, profile_args, size(profile_args), profile_types);
+			countallocations = true;
+			break;
+		case INPUT_FORMAT_OPTION:
+			format = xargmatch("--input-format", optarg, format_args, size(format_args), format_types);
+			break;
+		case BINARY_COLUMNS_OPTION:
+			binary_columns = strtoul(optarg, &p, frombase);
+			if (*p)
+			{
+				cerr << "Usage: <COLUMNS> is not a valid integer number: " << quoted(optarg) << ".\n";
+				return 1;
+			}
+			if (errno == ERANGE)
+			{
+				cerr << "Error: Integer number for <COLUMNS> is too large to input: " << quoted(optarg) << " (" << strerror(errno) << ").\n";
+				return 1;
+			}
+			if (!binary_columns)
+			{
+				cerr << "Usage: <COLUMNS> must be greater than 0: " << quoted(optarg) << ".\n";
+				return 1;
+			}
+			break;
+		case INDEX_OPTION:
+			index = true;
+			break;
+		case CSV_OPTION:
+			quoted_delimiter = ",";
+			break;
+		case TSV_OPTION:
+			quoted_delimiter = "\t";
+			break;
+		case FIELDS_OPTION:
+			if (!fields.parse(optarg))
+			{
+				cerr << "Usage: <LIST> is not a valid list of fields: " << quoted(optarg) << ".\n";
+				return 1;
+			}
+			break;
+		case BINS_OPTION:
+			nbins = strtoul(optarg, &p, frombase);
+			if (*p)
+			{
+				cerr << "Usage: <BINS> is not a valid integer number: " << quoted(optarg) << ".\n";
+				return 1;
+			}
+			if (errno == ERANGE)
+			{
+				cerr << "Error: Integer number for <BINS> is too large to input: " << quoted(optarg) << " (" << strerror(errno) << ").\n";
+				return 1;
+			}
+			break;
+		case HEAD_OPTION:
+			alimits.head = strtoul(optarg, &p, frombase);
+			if (*p)
+			{
+				cerr << "Usage: <ROWS> is not a valid integer number: " << quoted(optarg) << ".\n";
+				return 1;
+			}
+			if (errno == ERANGE)
+			{
+				cerr << "Error: Integer number for <ROWS> is too large to input: " << quoted(optarg) << " (" << strerror(errno) << ").\n";
+				return 1;
+			}
+			break;
+		case TAIL_OPTION:
+			alimits.tail = strtoul(optarg, &p, frombase);
+			if (*p)
+			{
+				cerr << "Usage: <ROWS> is not a valid integer number: " << quoted(optarg) << ".\n";
+				return 1;
+			}
+			if (errno == ERANGE)
+			{
+				cerr << "Error: Integer number for <ROWS> is too large to input: " << quoted(optarg) << " (" << strerror(errno) << ").\n";
+				return 1;
+			}
+			break;
+		case GETOPT_HELP_CHAR:
+			usage(argv[0]);
+			return 0;
+		case GETOPT_VERSION_CHAR:
+			cout << "Graph 1.0\n\n";
+			return 0;
+		case '?':
+			cerr << "Try '" << argv[0] << " --help' for more information.\n";
+			return 1;
+		default:
+			abort();
+		}
+	}
+
+	const bool csv = quoted_delimiter;
+	if (csv and !delimiter)
+		delimiter = quoted_delimiter;
+
+	aprofiler.phase("options");
+
+	if (format != format_text and (follow or nbins or stats))
+	{
+		cerr << "Error: The binary input formats are not supported with --follow, --bins or --stats.\n";
+		return 1;
+	}
+
+	if (follow and (alimits.head != SIZE_MAX or alimits.tail != SIZE_MAX))
+	{
+		cerr << "Error: --head and --tail are not supported with --follow.\n";
+		return 1;
+	}
+
+	auto outputlegend = [&](const size_t arrays, const size_t columns)
+	{
+		tables::options tableoptions;
+		tableoptions.check = false;
+		tableoptions.tableborder = aoptions.border;
+		tableoptions.style = tables::style_types[aoptions.style];
+
+		vector<array<string, 2>> aarray(arrays);
+
+		// The mark and reset are the same for every series
+		const string mark = string(columns == 1 ? graphs::bars[8] : aoptions.type == graphs::type_braille ? graphs::dots[255]
+																										 : graphs::blocks_quadrant[15]) +
+							graphs::outputcolor(graphs::color_default);
+
+		for (size_t i = 0; i < arrays; ++i)
+		{
+			const unsigned acolor = arrays == 1 ? aoptions.color : (i % (size(graphs::colors) - 2)) + 2;
+			aarray[i] = {graphs::outputcolor(graphs::color_type(acolor)) + mark, names[i]};
+		}
+
+		column((width / 2) + (aoptions.border ? 2 : 0), aarray, tableoptions);
+	};
+
+	if (follow)
+	{
+		auto afollow = [&]<typename T>() -> int
+		{
+			struct source
+			{
+				int fd;
+				bool regular;
+				bool header;
+				string buffer;
+				size_t line;
+			};
+
+			vector<source> sources;
+
+			if (optind < argc)
+			{
+				for (int i = optind; i < argc; ++i)
+				{
+					const int fd = string(argv[i]) == "-" ? STDIN_FILENO : open(argv[i], O_RDONLY);
+
+					if (fd != -1)
+						sources.push_back({fd, false, false, {}, 0});
+					else
+						cerr << "Error: Unable to open the " << quoted(argv[i]) << " file (" << strerror(errno) << ").\n";
+				}
+			}
+			else
+			{
+				sources.push_back({STDIN_FILENO, false, false, {}, 0});
+			}
+
+			if (sources.empty())
+				return 0;
+
+			vector<pollfd> fds(sources.size());
+
+			for (size_t i = 0; i < sources.size(); ++i)
+			{
+				struct stat st;
+				sources[i].regular = fstat(sources[i].fd, &st) != -1 and S_ISREG(st.st_mode);
+				sources[i].header = legend and names.empty();
+				fds[i] = {sources[i].fd, POLLIN, 0};
+			}
+
+			// With multiple inputs, each input is a series, otherwise each y column is a series
+			const bool multiple = sources.size() > 1;
+
+			vector<deque<array<T, 2>>> aarray(multiple ? sources.size() : 0);
+			vector<window<T>> windows(aarray.size());
+
+			auto add = [&](const size_t j, const array<T, 2> &point)
+			{
+				if (j >= aarray.size())
+				{
+					aarray.resize(j + 1);
+					windows.resize(j + 1);
+				}
+
+				auto &array = aarray[j];
+				auto &awindow = windows[j];
+
+				array.push_back(point);
+				awindow.push(point);
+
+				while ((points and array.size() > points) or (span and array.back()[0] - array.front()[0] > span))
+				{
+					array.pop_front();
+					awindow.pop();
+				}
+			};
+
+			const delimiters adelimiters(delimiter, line_delim, csv, fields);
+			vector<string_view> tokens;
+			string token;
+			string escaped;
+
+			auto parse = [&](source &asource, const size_t k, const string_view &line) -> bool
+			{
+				tokens.clear();
+				if (csv)
+					tokenize(line, adelimiters, tokens, escaped);
+				else
+					tokenize(line, adelimiters, tokens);
+
+				if (asource.header)
+				{
+					asource.header = false;
+
+					if (multiple)
+					{
+						if (names.size() <= k)
+							names.resize(k + 1);
+						if (tokens.size() > 1)
+							names[k] = tokens[1];
+					}
+					else
+						names.insert(names.end(), tokens.cbegin() + min(tokens.size(), size_t(1)), tokens.cend());
+
+					return true;
+				}
+
+				if (tokens.size() < 2)
+					return true;
+
+				auto convert = [&](const string_view &atoken, T &number)
+				{
+					if (precision == precision_double)
+						return fromchars(atoken, number, asource.line, cerr);
+					token = atoken;
+					return tonumber(token.c_str(), number, frombase, cerr);
+				};
+
+				array<T, 2> point;
+				if (!convert(tokens[0], point[0]))
+					return false;
+
+				for (size_t j = 1; j < (multiple ? 2 : tokens.size()); ++j)
+				{
+					if (!convert(tokens[j], point[1]))
+						return false;
+
+					add(multiple ? k : j - 1, point);
+				}
+
+				return true;
+			};
+
+			auto lines = [&](source &asource, const size_t k, const bool eof) -> bool
+			{
+				const string_view buffer(asource.buffer);
+
+				size_t start = 0;
+				for (;;)
+				{
+					size_t end = buffer.find(line_delim, start);
+					if (end == string_view::npos)
+					{
+						if (!eof or start == buffer.size())
+							break;
+						end = buffer.size();
+					}
+
+					const string_view line = buffer.substr(start, end - start);
+					start = min(end + 1, buffer.size());
+					++asource.line;
+
+					if (!line.empty() and !parse(asource, k, line))
+						return false;
+				}
+
+				asource.buffer.erase(0, start);
+
+				return true;
+			};
+
+			bool first = true;
+
+			auto draw = [&]() -> int
+			{
+				if (aarray.empty() or any_of(aarray.cbegin(), aarray.cend(), [](const auto &array)
+											 { return array.empty(); }))
+					return 0;
+
+				const size_t arrays = aarray.size();
+
+				long double axmin = xmin;
+				long double axmax = xmax;
+				long double aymin = ymin;
+				long double aymax = ymax;
+
+				if (axmin == 0 and axmax == 0)
+				{
+					axmin = min_element(windows.cbegin(), windows.cend(), [](const auto &a, const auto &b)
+										{ return a.min(0) < b.min(0); })
+								->min(0);
+					axmax = max_element(windows.cbegin(), windows.cend(), [](const auto &a, const auto &b)
+										{ return a.max(0) < b.max(0); })
+								->max(0);
+				}
+
+				if (aymin == 0 and aymax == 0)
+				{
+					aymin = min_element(windows.cbegin(), windows.cend(), [](const auto &a, const auto &b)
+										{ return a.min(1) < b.min(1); })
+								->min(1);
+					aymax = max_element(windows.cbegin(), windows.cend(), [](const auto &a, const auto &b)
+										{ return a.max(1) < b.max(1); })
+								->max(1);
+				}
+
+				// Move the cursor to the top left corner, so that the plot is redrawn in place
+				cout << (first ? "\e[H\e[2J" : "\e[H");
+				first = false;
+
+				const int code = graphs::plots(height, width, axmin, axmax, aymin, aymax, aarray, aoptions);
+
+				if (legend)
+				{
+					if (names.size() == 1 and arrays != 1)
+						names = split(names[0]);
+					names.resize(arrays);
+
+					outputlegend(arrays, 2);
+				}
+
+				// Clear the rest of the previous plot
+				cout << "\e[J" << flush;
+
+				return code;
+			};
+
+			const auto refresh = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<long double>(interval));
+			auto next = chrono::steady_clock::now() + refresh;
+
+			vector<char> abuffer(1 << 16);
+			size_t open = sources.size();
+			bool changed = false;
+			int code = 0;
+
+			while (open)
+			{
+				const auto now = chrono::steady_clock::now();
+
+				if (now >= next)
+				{
+					if (changed)
+						code = draw();
+					changed = false;
+					next = now + refresh;
+
+					// Check the regular files for new data again
+					for (size_t i = 0; i < sources.size(); ++i)
+						if (sources[i].fd != -1)
+							fds[i].fd = sources[i].fd;
+				}
+
+				const int timeout = chrono::duration_cast<chrono::milliseconds>(next - now).count() + 1;
+				if (poll(fds.data(), fds.size(), timeout) == -1)
+				{
+					if (errno == EINTR)
+						continue;
+					cerr << "Error: Unable to poll the inputs (" << strerror(errno) << ").\n";
+					return 1;
+				}
+
+				for (size_t i = 0; i < sources.size(); ++i)
+				{
+					if (fds[i].fd == -1 or !fds[i].revents)
+						continue;
+
+					auto &asource = sources[i];
+					const ssize_t n = read(asource.fd, abuffer.data(), abuffer.size());
+
+					if (n > 0)
+					{
+						bytesread += n;
+						asource.buffer.append(abuffer.data(), n);
+						if (!lines(asource, i, false))
+							return 1;
+						changed = true;
+					}
+					else if (n == 0 and asource.regular)
+					{
+						// Wait until the next refresh before checking a growing file again
+						fds[i].fd = -1;
+					}
+					else if (n == 0 or (errno != EINTR and errno != EAGAIN))
+					{
+						if (!lines(asource, i, true))
+							return 1;
+						fds[i].fd = -1;
+						asource.fd = -1;
+						--open;
+					}
+				}
+			}
+
+			if (changed)
+				code = draw();
+
+			// Reading, parsing and rendering are interleaved when following
+			aprofiler.phase("follow");
+
+			return code;
+		};
+
+		return integer ? afollow.operator()<intmax_t>() : precision == precision_double ? afollow.operator()<double>()
+																						: afollow.operator()<long double>();
 	}
 
-	vector<vector<vector<string>>> aaarray;
+	if (!jobs)
+		jobs = max(thread::hardware_concurrency(), 1u);
+
+	// File descriptor of each input
+	vector<int> fds;
 
 	if (optind < argc)
 	{
 		for (int i = optind; i < argc; ++i)
 		{
-			if (string(argv[i]) == "-")
+			const char *const filename = argv[i];
+			if (string(filename) == "-")
 			{
-				aaarray.push_back(input(cin, delimiter, line_delim));
+				fds.push_back(STDIN_FILENO);
+				continue;
 			}
-			else
-			{
-				ifstream fin(argv[i]);
 
-				if (fin)
-				{
-					aaarray.push_back(input(fin, delimiter, line_delim));
+			const int fd = open(filename, O_RDONLY);
 
-					// fin.close();
-				}
-				else
-					cerr << "Error: Unable to open the " << quoted(argv[i]) << " file (" << strerror(errno) << ").\n";
+			if (fd == -1)
+			{
+				cerr << "Error: Unable to open the " << quoted(filename) << " file (" << strerror(errno) << ").\n";
+				continue;
 			}
+
+			fds.push_back(fd);
 		}
 	}
 	else
-	{
-		aaarray.push_back(input(cin, delimiter, line_delim));
-	}
+		fds.push_back(STDIN_FILENO);
 
-	if (aaarray.empty() or (aaarray.size() == 1 and aaarray[0].empty()))
+	aprofiler.phase("open");
+
+	if (fds.empty())
 		return 0;
 
-	if (aaarray.size() == 1)
-	{
-		const size_t max = (*max_element(aaarray[0].cbegin(), aaarray[0].cend(), [](const auto &a, const auto &b)
-										 { return a.size() < b.size(); }))
-							   .size();
+	// With a single input, each of its columns after the first is a series
+	const bool single = fds.size() == 1;
 
-		if (max > 2)
+	if (stats)
+	{
+		auto astats = [&]<typename T>() -> int
 		{
-			for (size_t i = 2; i < max; ++i)
+			const size_t n = fds.size();
+			// Summary of each column of each input, only the first two with multiple inputs
+			vector<vector<summary>> summaries(n);
+			vector<vector<string>> headers(n);
+			vector<string> errors(n);
+			const size_t limit = single ? SIZE_MAX : 2;
+
+			auto arow = [&](vector<summary> &asummaries, string &error, ostringstream &err, const vector<string_view> &tokens, const size_t line)
+			{
+				if (!error.empty())
+					return;
+
+				if (asummaries.size() < min(tokens.size(), limit))
+					asummaries.resize(min(tokens.size(), limit));
+
+				for (size_t j = 0; j < min(tokens.size(), limit); ++j)
+				{
+					T number;
+					bool valid;
+					if (precision == precision_double)
+						valid = fromchars(tokens[j], number, line, err);
+					else
+					{
+						thread_local string temp;
+						temp = tokens[j];
+						valid = tonumber(temp.c_str(), number, frombase, err);
+					}
+					if (!valid)
+					{
+						error = err.str();
+						return;
+					}
+					asummaries[j].add(number);
+				}
+			};
+
+			auto aread = [&](const size_t k, const unsigned ajobs)
 			{
-				vector<vector<string>> temp;
-				temp.reserve(aaarray[0].size());
+				const delimiters adelimiters(delimiter, line_delim, csv, fields);
+				bool header = legend and names.empty();
 
-				for (const auto &array : aaarray[0])
+				auto aheader = [&](const vector<string_view> &tokens, const size_t)
 				{
-					if (array.size() > i)
+					header = false;
+					headers[k].assign(tokens.cbegin(), tokens.cend());
+				};
+
+				string_view buffer;
+				if (mapfile(fds[k], buffer))
+				{
+					size_t line = 0;
+					while (header and !buffer.empty())
+					{
+						size_t end = buffer.find(line_delim);
+						end = end != string_view::npos ? end + 1 : buffer.size();
+
+						line = rows(buffer.substr(0, end), adelimiters, line, aheader);
+						buffer.remove_prefix(end);
+					}
+
+					buffer = limitrows(buffer, alimits, line_delim);
+
+					const vector<string_view> chunks = chunk(buffer, line_delim, ajobs);
+					const vector<size_t> alines = lines(chunks, line_delim, line, ajobs);
+					vector<vector<summary>> asummaries(chunks.size());
+					vector<string> aerrors(chunks.size());
+
+					parallel(chunks.size(), ajobs, [&](const size_t i)
+							 {
+						ostringstream err;
+						rows(chunks[i], adelimiters, alines[i], [&](const vector<string_view> &tokens, const size_t aline)
+							 { arow(asummaries[i], aerrors[i], err, tokens, aline); }); });
+
+					for (size_t i = 0; i < chunks.size(); ++i)
 					{
-						temp.push_back({array[0], array[i]});
+						if (errors[k].empty())
+							errors[k] = aerrors[i];
+						if (summaries[k].size() < asummaries[i].size())
+							summaries[k].resize(asummaries[i].size());
+						for (size_t j = 0; j < asummaries[i].size(); ++j)
+							summaries[k][j].merge(asummaries[i][j]);
 					}
 				}
+				else
+				{
+					size_t line = 0;
+					ostringstream err;
+
+					readlines(fds[k], line_delim, header, alimits, [&](const string_view &abuffer)
+							  { line = rows(abuffer, adelimiters, line, [&](const vector<string_view> &tokens, const size_t aline)
+											{
+								if (header)
+									aheader(tokens, aline);
+								else
+									arow(summaries[k], errors[k], err, tokens, aline); }); });
+				}
+
+				if (fds[k] != STDIN_FILENO)
+					close(fds[k]);
+			};
+
+			// Standard input can only be read once, so it is read first on this thread
+			for (size_t k = 0; k < n; ++k)
+				if (fds[k] == STDIN_FILENO)
+					aread(k, jobs);
+
+			const unsigned ajobs = max(jobs / static_cast<unsigned>(n), 1u);
 
-				aaarray.push_back(temp);
+			parallel(n, jobs, [&](const size_t k)
+					 {
+				if (fds[k] != STDIN_FILENO)
+					aread(k, ajobs); });
+
+			// Output only the first error, in the order of the inputs
+			const auto error = find_if(errors.cbegin(), errors.cend(), [](const string &aerror)
+									   { return !aerror.empty(); });
+			if (error != errors.cend())
+			{
+				cerr << *error;
+				return 1;
 			}
 
-			if (!all_of(aaarray[0].cbegin(), aaarray[0].cend(), [&max](const auto &array)
-						{ return array.size() == max; }))
+			if (readerror)
+				return 1;
+
+			aprofiler.phase("input");
+
+			for (const auto &asummaries : summaries)
 			{
-				cerr << "Warning: The rows of the array should have the same number of columns (" << max << ").\n";
+				if (!asummaries.empty())
+					aprofiler.rows += asummaries[0].count;
+				for (const auto &asummary : asummaries)
+					aprofiler.cells += asummary.count;
 			}
 
-			for (auto &array : aaarray[0])
+			// The series, as they would be plotted, or the values of a histogram
+			const bool histogram = all_of(summaries.cbegin(), summaries.cend(), [](const auto &asummaries)
+										  { return asummaries.size() <= 1; });
+			vector<summary *> asummaries;
+			vector<string> anames;
+			for (size_t k = 0; k < n; ++k)
 			{
-				if (array.size() != 2)
-					array.resize(2);
+				for (size_t j = histogram ? 0 : 1; j < (histogram ? min<size_t>(summaries[k].size(), 1) : summaries[k].size()); ++j)
+				{
+					asummaries.push_back(&summaries[k][j]);
+					anames.push_back(j < headers[k].size() ? headers[k][j] : "");
+				}
 			}
-		}
-	}
 
-	size_t max = 0;
-	for (auto &array : aaarray)
-	{
-		const size_t amax = (*max_element(array.cbegin(), array.cend(), [](const auto &a, const auto &b)
-										  { return a.size() < b.size(); }))
-								.size();
-		if (amax > max)
-			max = amax;
-	}
+			const size_t arrays = asummaries.size();
 
-	const size_t columns = max == 1 ? 1 : 2;
+			if (!names.empty())
+			{
+				if (names.size() == 1 and arrays != 1)
+					names = split(names[0]);
 
-	if (!all_of(aaarray.cbegin(), aaarray.cend(), [&columns](const auto &array)
-				{ return all_of(array.cbegin(), array.cend(), [columns](const auto &x)
-								{ return x.size() == columns; }); }))
-	{
-		cerr << "Warning: The array should have one or two columns.\n";
+				if (names.size() != arrays)
+				{
+					cerr << "Warning: There are not the same number of names (" << names.size() << ") as inputs/series (" << arrays << ").\n";
+					names.resize(arrays);
+				}
+			}
+			else if (legend)
+				names = anames;
+			else
+				for (size_t i = 0; i < arrays; ++i)
+					names.push_back(to_string(i + 1));
 
-		for (auto &array : aaarray)
-		{
-			for (auto &x : array)
+			const vector<string> header = {"Series", "Count", "Min", "Max", "Mean", "Std Dev", "p50", "p90", "p99", "p99.9"};
+			vector<vector<string>> aarray;
+
+			for (size_t i = 0; i < arrays; ++i)
 			{
-				if (x.size() != columns)
-					x.resize(columns);
+				auto &asummary = *asummaries[i];
+				const long double values[] = {asummary.min, asummary.max, asummary.mean, asummary.stddev(), asummary.quantile(0.5), asummary.quantile(0.9), asummary.quantile(0.99), asummary.quantile(0.999)};
+
+				vector<string> row = {names[i], to_string(asummary.count)};
+				for (const long double value : values)
+				{
+					ostringstream strm;
+					strm << value;
+					row.push_back(strm.str());
+				}
+				aarray.push_back(row);
 			}
-		}
-	}
 
-	const size_t arrays = aaarray.size();
+			if (aarray.empty())
+				return 0;
 
-	if (columns == 1 and arrays != 1)
-	{
-		cerr << "Warning: Only one input/series supported for histograms (" << arrays << ").\n";
-	}
+			tables::options tableoptions;
+			tableoptions.check = false;
+			tableoptions.headerrow = true;
+			tableoptions.headercolumn = true;
+			tableoptions.style = tables::style_types[aoptions.style];
+			tableoptions.title = aoptions.title;
 
-	if (!names.empty())
-	{
-		if (names.size() == 1 and arrays != 1)
-			names = split(names[0]);
+			aprofiler.phase("stats");
 
-		if (names.size() != arrays)
-		{
-			cerr << "Warning: There are not the same number of names (" << names.size() << ") as inputs/series (" << arrays << ").\n";
-			names.resize(arrays);
-		}
+			const int code = tables::array(aarray, header.data(), nullptr, tableoptions);
+
+			aprofiler.phase("render");
+
+			return code;
+		};
+
+		return integer ? astats.operator()<intmax_t>() : precision == precision_double ? astats.operator()<double>()
+																					   : astats.operator()<long double>();
 	}
-	else if (legend)
+
+	if (nbins)
 	{
-		for (auto &array : aaarray)
+		auto abins = [&]<typename T>() -> int
 		{
-			if (!array.empty())
+			if (fds.size() > 1)
 			{
-				names.push_back(array[0][1]);
-				array.erase(array.begin());
+				cerr << "Warning: Only one input/series supported for histograms (" << fds.size() << ").\n";
+				for (size_t k = 1; k < fds.size(); ++k)
+					if (fds[k] != STDIN_FILENO)
+						close(fds[k]);
 			}
-		}
-	}
 
-	auto ainput = [&]<typename T>() -> int
-	{
-		vector<vector<vector<T>>> aarray;
-		aarray.reserve(arrays);
+			const int fd = fds[0];
+			const delimiters adelimiters(delimiter, line_delim, csv, fields);
+			// The range is known, so the values can be binned as they are read
+			const bool fixed = xmin != 0 or xmax != 0;
+			bool header = legend and names.empty();
+			string name;
 
-		for (const auto &array : aaarray)
-		{
-			vector<vector<T>> temp;
-			temp.reserve(array.size());
+			// Convert the value of the first column of a row, which is 0 if the row is empty
+			auto value = [&](const vector<string_view> &tokens, const size_t line, long double &number, ostream &err)
+			{
+				T x = 0;
+				if (!tokens.empty())
+				{
+					if (precision == precision_double)
+					{
+						if (!fromchars(tokens[0], x, line, err))
+							return false;
+					}
+					else
+					{
+						thread_local string temp;
+						temp = tokens[0];
+						if (!tonumber(temp.c_str(), x, frombase, err))
+							return false;
+					}
+				}
+				number = x;
+				return true;
+			};
 
-			for (const auto &x : array)
+			auto aheader = [&](const vector<string_view> &tokens, const size_t)
 			{
-				vector<T> atemp;
-				atemp.reserve(x.size());
+				header = false;
+				if (!tokens.empty())
+					name = tokens[0];
+			};
 
-				for (const auto &y : x)
+			bins abins(nbins, xmin, xmax);
+			string error;
+
+			string_view buffer;
+			if (mapfile(fd, buffer))
+			{
+				if (fd != STDIN_FILENO)
+					close(fd);
+
+				size_t line = 0;
+				while (header and !buffer.empty())
 				{
-					const char *const token = y.c_str();
-					T number;
-					if constexpr (is_integral_v<T>)
+					size_t end = buffer.find(line_delim);
+					end = end != string_view::npos ? end + 1 : buffer.size();
+
+					line = rows(buffer.substr(0, end), adelimiters, line, aheader);
+					buffer.remove_prefix(end);
+				}
+
+				buffer = limitrows(buffer, alimits, line_delim);
+
+				const vector<string_view> chunks = chunk(buffer, line_delim, jobs);
+				const vector<size_t> alines = lines(chunks, line_delim, line, jobs);
+				vector<string> errors(chunks.size());
+
+				// Otherwise, the first pass finds the range of the values
+				if (!fixed)
+				{
+					vector<pair<long double, long double>> ranges(chunks.size(), {numeric_limits<long double>::infinity(), -numeric_limits<long double>::infinity()});
+
+					parallel(chunks.size(), jobs, [&](const size_t i)
+							 {
+						ostringstream err;
+						rows(chunks[i], adelimiters, alines[i], [&](const vector<string_view> &tokens, const size_t aline)
+							 {
+							long double x;
+							if (!errors[i].empty())
+								return;
+							if (!value(tokens, aline, x, err))
+							{
+								errors[i] = err.str();
+								return;
+							}
+							// Infinite and NaN values are outside every range, so they are not counted
+							if (isfinite(x))
+							{
+								ranges[i].first = std::min(ranges[i].first, x);
+								ranges[i].second = std::max(ranges[i].second, x);
+							} }); });
+
+					abins = bins(nbins, numeric_limits<long double>::infinity(), -numeric_limits<long double>::infinity(), true);
+					for (const auto &range : ranges)
 					{
-						char *p;
-						number = strtoimax(token, &p, frombase);
-						if (*p)
-						{
-							cerr << "Warning: Invalid integer number: " << quoted(token) << ".\n";
-							return 1;
-						}
-						if (errno == ERANGE)
-						{
-							cerr << "Warning: Integer number too large to input: " << quoted(token) << " (" << strerror(errno) << ").\n";
-							return 1;
-						}
+						abins.min = std::min(abins.min, range.first);
+						abins.max = std::max(abins.max, range.second);
+					}
+				}
+
+				const auto aerror = find_if(errors.cbegin(), errors.cend(), [](const string &e)
+											{ return !e.empty(); });
+				if (aerror != errors.cend())
+					error = *aerror;
+				else if (abins.min <= abins.max)
+				{
+					vector<bins> abinss(chunks.size(), abins);
+
+					parallel(chunks.size(), jobs, [&](const size_t i)
+							 {
+						ostringstream err;
+						rows(chunks[i], adelimiters, alines[i], [&](const vector<string_view> &tokens, const size_t aline)
+							 {
+							long double x;
+							if (!errors[i].empty())
+								return;
+							if (!value(tokens, aline, x, err))
+							{
+								errors[i] = err.str();
+								return;
+							}
+							abinss[i].add(x); }); });
+
+					const auto aerror = find_if(errors.cbegin(), errors.cend(), [](const string &e)
+												{ return !e.empty(); });
+					if (aerror != errors.cend())
+						error = *aerror;
+
+					for (const auto &temp : abinss)
+						abins.merge(temp);
+				}
+			}
+			else
+			{
+				// Otherwise, the range starts from that of the first values, then doubles as needed
+				// There are 16 times more bins, which are then counted in BINS bins from the minimum to the maximum value.
+				const size_t block = 1 << 16;
+				const size_t scale = 16;
+				vector<long double> values;
+				bool adaptive = false;
+				long double amin = numeric_limits<long double>::infinity();
+				long double amax = -amin;
+				size_t line = 0;
+				ostringstream err;
+
+				auto add = [&](const long double x)
+				{
+					if (fixed)
+						abins.add(x);
+					// Infinite and NaN values are outside every range, so they are not counted
+					else if (!isfinite(x))
+						return;
+					else if (adaptive)
+					{
+						amin = std::min(amin, x);
+						amax = std::max(amax, x);
+						abins.grow(x);
+						abins.add(x);
 					}
 					else
+						values.push_back(x);
+				};
+
+				// Bin the values read so far
+				auto start = [&](const bool closed)
+				{
+					const auto [first, last] = minmax_element(values.cbegin(), values.cend());
+					long double min = *first, max = *last;
+					if (!closed)
 					{
-						char *p;
-						number = strtold(token, &p);
-						if (*p)
+						amin = min;
+						amax = max;
+						// So that the maximum is within the half-open range
+						max = min < max ? min + ((max - min) * (nbins * scale) / (nbins * scale - 1)) : min + 1;
+					}
+					abins = bins(closed ? nbins : nbins * scale, min, max, closed);
+					for (const long double x : values)
+						abins.add(x);
+					values.clear();
+					values.shrink_to_fit();
+				};
+
+				readlines(fd, line_delim, header, alimits, [&](const string_view &abuffer)
+						  {
+					if (!error.empty())
+						return;
+					line = rows(abuffer, adelimiters, line, [&](const vector<string_view> &tokens, const size_t aline)
+								{
+						if (header)
 						{
-							cerr << "Warning: Invalid floating point number: " << quoted(token) << ".\n";
-							return 1;
+							aheader(tokens, aline);
+							return;
 						}
-						if (errno == ERANGE)
+						long double x;
+						if (!error.empty())
+							return;
+						if (!value(tokens, aline, x, err))
 						{
-							cerr << "Warning: Floating point number too large to input: " << quoted(token) << " (" << strerror(errno) << ").\n";
-							return 1;
+							error = err.str();
+							return;
 						}
-					}
-					atemp.push_back(number);
+						add(x);
+						if (!fixed and !adaptive and values.size() >= block)
+						{
+							start(false);
+							adaptive = true;
+						} }); });
+
+				if (fd != STDIN_FILENO)
+					close(fd);
+
+				if (!fixed and !adaptive and !values.empty())
+					start(true);
+
+				if (adaptive)
+				{
+					bins temp(nbins, amin, amax, true);
+					const long double step = abins.step();
+					for (size_t i = 0; i < abins.counts.size(); ++i)
+						if (abins.counts[i])
+							temp.add(std::clamp(abins.min + (i + 0.5) * step, amin, amax), abins.counts[i]);
+					abins = temp;
 				}
+			}
+
+			if (!error.empty())
+			{
+				cerr << error;
+				return 1;
+			}
+
+			if (readerror)
+				return 1;
+
+			// Reading, parsing and binning are done in the same pass
+			aprofiler.phase("input");
+			aprofiler.rows = aprofiler.cells = abins.total;
+
+			if (!abins.total and !fixed)
+				return 0;
+
+			if (!names.empty())
+			{
+				if (names.size() != 1)
+				{
+					cerr << "Warning: There are not the same number of names (" << names.size() << ") as inputs/series (1).\n";
+					names.resize(1);
+				}
+			}
+			else if (legend)
+				names = {name};
+
+			const int code = graphs::histogram(height, width, abins.min, abins.max, ymin, ymax, binvalues(abins.counts, abins.min, abins.step()), aoptions);
+
+			if (legend)
+				outputlegend(1, 1);
 
-				temp.push_back(atemp);
+			aprofiler.phase("render");
+
+			return code;
+		};
+
+		return integer ? abins.operator()<intmax_t>() : precision == precision_double ? abins.operator()<double>()
+																					 : abins.operator()<long double>();
+	}
+
+	auto ainput = [&]<typename T>() -> int
+	{
+		const size_t n = fds.size();
+		vector<series<T>> aseries(n);
+
+		auto convert = [&](const string_view &token, T &number, const size_t line, ostream &err)
+		{
+			if (precision == precision_double)
+				return fromchars(token, number, line, err);
+			thread_local string temp;
+			temp = token;
+			return tonumber(temp.c_str(), number, frombase, err);
+		};
+
+		auto aread = [&](const size_t k, const unsigned ajobs)
+		{
+			const delimiters adelimiters(delimiter, line_delim, csv, fields);
+			const bool header = legend and names.empty();
+
+			string_view buffer;
+			if (format != format_text)
+			{
+				if (!input(fds[k], format, binary_columns, fields, index, single, alimits, aseries[k], ajobs))
+					cerr << "Warning: The input has a partial record at the end, which is ignored.\n";
 			}
+			else if (mapfile(fds[k], buffer))
+				input(buffer, adelimiters, single, header, alimits, aseries[k], ajobs, convert);
+			else
+				input(fds[k], adelimiters, single, header, alimits, aseries[k], convert);
+
+			if (fds[k] != STDIN_FILENO)
+				close(fds[k]);
+		};
+
+		// Standard input can only be read once, so it is read first on this thread
+		for (size_t k = 0; k < n; ++k)
+			if (fds[k] == STDIN_FILENO)
+				aread(k, jobs);
+
+		// The files are independent, so they are read at the same time, and each is split into chunks for the remaining threads
+		const unsigned ajobs = max(jobs / static_cast<unsigned>(n), 1u);
 
-			aarray.push_back(temp);
+		parallel(n, jobs, [&](const size_t k)
+				 {
+			if (fds[k] != STDIN_FILENO)
+				aread(k, ajobs); });
+
+		if (readerror)
+			return 1;
+
+		// Reading, tokenizing and converting are done in the same pass
+		aprofiler.phase("input");
+
+		for (const auto &temp : aseries)
+		{
+			aprofiler.rows += temp.rows;
+			aprofiler.cells += temp.cells;
 		}
 
-		if (columns == 1)
+		if (single and !aseries[0].rows)
+			return 0;
+
+		size_t max = 0;
+		for (const auto &temp : aseries)
+			if (temp.rows and temp.maxwidth > max)
+				max = temp.maxwidth;
+
+		const size_t columns = max == 1 ? 1 : 2;
+
+		// The first row of each input is included in the widths, even if it is the header
+		if (single and max > 2)
+		{
+			if (aseries[0].minwidth != max)
+				cerr << "Warning: The rows of the array should have the same number of columns (" << max << ").\n";
+		}
+		else if (!all_of(aseries.cbegin(), aseries.cend(), [&columns](const auto &temp)
+						 { return !temp.rows or (temp.minwidth == columns and temp.maxwidth == columns); }))
 		{
-			vector<T> aaaarray;
-			aaaarray.reserve(aarray[0].size());
+			cerr << "Warning: The array should have one or two columns.\n";
+		}
+
+		vector<vector<array<T, 2>>> aarray;
+		vector<string> errors;
+		vector<string> anames;
 
-			for (const auto &x : aarray[0])
-				aaaarray.push_back(x[0]);
+		if (single)
+		{
+			auto &temp = aseries[0];
+			const size_t arrays = std::max(temp.arrays.size(), size_t(1));
+			temp.arrays.resize(arrays);
+			temp.errors.resize(arrays);
+			temp.names.resize(arrays);
 
-			return graphs::histogram(height, width, xmin, xmax, ymin, ymax, aaaarray, aoptions);
+			aarray = move(temp.arrays);
+			errors = move(temp.errors);
+			anames = move(temp.names);
 		}
+		else
+		{
+			aarray.reserve(n);
+			errors.reserve(n);
+			for (auto &temp : aseries)
+			{
+				temp.arrays.resize(1);
+				temp.errors.resize(1);
+				temp.names.resize(1);
 
-		return graphs::plots(height, width, xmin, xmax, ymin, ymax, aarray, aoptions);
-	};
+				aarray.push_back(move(temp.arrays[0]));
+				errors.push_back(move(temp.errors[0]));
+				anames.push_back(move(temp.names[0]));
+			}
+		}
 
-	const int code = integer ? ainput.operator()<intmax_t>() : ainput.operator()<long double>();
+		const size_t arrays = aarray.size();
 
-	if (legend)
-	{
-		tables::options tableoptions;
-		tableoptions.check = false;
-		tableoptions.tableborder = aoptions.border;
-		tableoptions.style = tables::style_types[aoptions.style];
+		if (columns == 1 and arrays != 1)
+		{
+			cerr << "Warning: Only one input/series supported for histograms (" << arrays << ").\n";
+		}
 
-		vector<array<string, 2>> aarray(arrays);
+		if (!names.empty())
+		{
+			if (names.size() == 1 and arrays != 1)
+				names = split(names[0]);
 
-		for (size_t i = 0; i < arrays; ++i)
+			if (names.size() != arrays)
+			{
+				cerr << "Warning: There are not the same number of names (" << names.size() << ") as inputs/series (" << arrays << ").\n";
+				names.resize(arrays);
+			}
+		}
+		else if (legend)
+			names = move(anames);
+
+		int code = 0;
+
+		// Output only the first error, in the order of the series
+		const auto error = find_if(errors.cbegin(), errors.cend(), [](const string &aerror)
+								   { return !aerror.empty(); });
+		if (error != errors.cend())
 		{
-			const unsigned acolor = arrays == 1 ? aoptions.color : (i % (size(graphs::colors) - 2)) + 2;
-			aarray[i] = {graphs::outputcolor(graphs::color_type(acolor)) + string(columns == 1 ? graphs::bars[8] : aoptions.type == graphs::type_braille ? graphs::dots[255]
-																																						 : graphs::blocks_quadrant[15]) +
-							 graphs::outputcolor(graphs::color_default),
-						 names[i]};
+			cerr << *error;
+			code = 1;
 		}
+		else if (columns == 1)
+		{
+			aprofiler.phase("range");
 
-		column((width / 2) + (aoptions.border ? 2 : 0), aarray, tableoptions);
-	}
+			code = graphs::histogram(height, width, xmin, xmax, ymin, ymax, xvalues<T>(aarray[0]), aoptions);
+		}
+		else
+		{
+			if (decimation)
+			{
+				size_t aheight = height;
+				size_t awidth = width;
+				if (!aheight or !awidth)
+				{
+					winsize w;
+					if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == -1)
+						w = {};
+					if (!aheight)
+						aheight = w.ws_row * 4;
+					if (!awidth)
+						awidth = w.ws_col * 2;
+				}
+
+				long double axmin = xmin, axmax = xmax, aymin = ymin, aymax = ymax;
+				if (axmin == 0 and axmax == 0)
+				{
+					axmin = numeric_limits<long double>::infinity();
+					axmax = -axmin;
+					for (const auto &array : aarray)
+						for (const auto &point : array)
+						{
+							axmin = std::min<long double>(axmin, point[0]);
+							axmax = std::max<long double>(axmax, point[0]);
+						}
+				}
+				if (aymin == 0 and aymax == 0)
+				{
+					aymin = numeric_limits<long double>::infinity();
+					aymax = -aymin;
+					for (const auto &array : aarray)
+						for (const auto &point : array)
+						{
+							aymin = std::min<long double>(aymin, point[1]);
+							aymax = std::max<long double>(aymax, point[1]);
+						}
+				}
+
+				// The width and height are in Braille dots, 2 columns and 4 rows for each character cell
+				// The grid has 2 columns and 3 rows for each of those dots, so 4 columns and 12 rows for each character cell, which the dots of every graph type (1x2 block, 2x2 quadrant, 2x3 sextant and 2x4 Braille or octant) divide evenly
+				if (aheight and awidth and isfinite(axmin) and isfinite(axmax) and isfinite(aymin) and isfinite(aymax))
+					parallel(arrays, jobs, [&](const size_t j)
+							 { decimate(aarray[j], awidth * 2, aheight * 3, axmin, axmax, aymin, aymax); });
+			}
+
+			// Finding the ranges and decimating the series
+			aprofiler.phase("range");
+
+			code = graphs::plots(height, width, xmin, xmax, ymin, ymax, aarray, aoptions);
+		}
+
+		if (legend)
+			outputlegend(arrays, columns);
+
+		aprofiler.phase("render");
+
+		return code;
+	};
 
-	return code;
+	return integer ? ainput.operator()<intmax_t>() : precision == precision_double ? ainput.operator()<double>()
+																				 : ainput.operator()<long double>();
 }
@@ -7,8 +7,30 @@
 // Run: ./table [OPTION(S)]... [FILE(S)]...
 
 #include <fstream>
+#include <atomic>
+#include <chrono>
 #include <climits>
+#include <condition_variable>
+#include <cwchar>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <dlfcn.h>
 #include <getopt.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 
 #include "tables.hpp"
 
@@ -16,83 +38,3092 @@ using namespace std;
 
 enum
 {
+	STREAM_OPTION = CHAR_MAX + 1,
+	WIDTHS_OPTION,
+	STATS_OPTION,
+	PROFILE_OPTION,
+	FILL_OPTION,
+	CSV_OPTION,
+	TSV_OPTION,
+	FIELDS_OPTION,
+	HEAD_OPTION,
+	TAIL_OPTION,
+	SORT_OPTION,
+	GROUP_BY_OPTION,
+	AGG_OPTION,
 	GETOPT_HELP_CHAR = CHAR_MIN - 2,
 	GETOPT_VERSION_CHAR = CHAR_MIN - 3
 };
 
 const char *const style_args[] = {"ascii", "basic", "light", "heavy", "double", "arc", "light-dashed", "heavy-dashed"};
 
+enum profile_type
+{
+	profile_text,
+	profile_json
+};
+
+const char *const profile_args[] = {"text", "json"};
+
+enum profile_type const profile_types[] = {profile_text, profile_json};
+
 // Check if the argument is in the argument list
 template <typename T>
 T xargmatch(const char *const context, const char *const arg, const char *const *arglist, const size_t argsize, const T vallist[])
 {
-	const size_t arglen = strlen(arg);
+	const size_t arglen = strlen(arg);
+
+	for (size_t i = 0; i < argsize; ++i)
+		if (!strncmp(arglist[i], arg, arglen) and strlen(arglist[i]) == arglen)
+			return vallist[i];
+
+	cerr << "Error: Invalid argument " << quoted(arg) << " for " << quoted(context) << '\n';
+	exit(1);
+
+	// return -1;
+}
+
+// Buffer for standard output, which is written with a few large write() calls instead of one for each piece of the output
+// SGR escape sequences that would not change the text attributes, such as a reset followed by the same color again, are skipped.
+class outputbuf : public streambuf
+{
+	ostream &strm;
+	streambuf *const original;
+	const int fd;
+	vector<char> buffer;
+	size_t size = 0;
+	bool failed = false;
+
+	// Escape sequence that has not been completed yet
+	string escape;
+	// Only SGR sequence since the last reset
+	string last;
+	size_t sequences = 0;
+	// A reset that has been deferred until the next output
+	bool reset = false;
+	// The text attributes are known to be the defaults
+	bool clean = false;
+
+	bool write()
+	{
+		const char *data = buffer.data();
+		while (size and !failed)
+		{
+			const ssize_t n = ::write(fd, data, size);
+			if (n == -1)
+			{
+				if (errno == EINTR)
+					continue;
+				failed = true;
+				break;
+			}
+			data += n;
+			size -= n;
+		}
+		size = 0;
+		return !failed;
+	}
+
+	void put(const char *s, size_t n)
+	{
+		while (n)
+		{
+			if (size == buffer.size())
+				write();
+			const size_t count = min(n, buffer.size() - size);
+			memcpy(buffer.data() + size, s, count);
+			size += count;
+			s += count;
+			n -= count;
+		}
+	}
+
+	// Output the deferred reset, if any
+	void pending()
+	{
+		if (!reset)
+			return;
+		put("\e[0m", 4);
+		reset = false;
+		clean = true;
+		last.clear();
+		sequences = 0;
+	}
+
+	// Output a complete escape sequence
+	void sequence()
+	{
+		if (escape.back() != 'm')
+		{
+			pending();
+			put(escape.data(), escape.size());
+			return;
+		}
+
+		if (escape == "\e[m" or escape == "\e[0m")
+		{
+			if (!clean)
+				reset = true;
+			return;
+		}
+
+		// Setting the same attributes again, with or without a reset in between, does not change them
+		if (sequences == 1 and escape == last)
+		{
+			reset = false;
+			return;
+		}
+
+		pending();
+		put(escape.data(), escape.size());
+		clean = false;
+		if (!sequences++)
+			last = escape;
+	}
+
+	void output(const char *s, size_t n)
+	{
+		while (n)
+		{
+			if (escape.empty())
+			{
+				const char *const end = static_cast<const char *>(memchr(s, '\e', n));
+				const size_t count = end ? end - s : n;
+				if (count)
+				{
+					pending();
+					put(s, count);
+				}
+				if (end)
+					escape = '\e';
+				const size_t skip = end ? count + 1 : count;
+				s += skip;
+				n -= skip;
+				continue;
+			}
+
+			// Control sequences are ESC [, then parameter and intermediate bytes, then a final byte
+			const unsigned char c = *s;
+			if (escape.size() == 1 ? c == '[' : c >= 0x20 and c <= 0x7E and escape.size() < 64)
+			{
+				escape += *s;
+				++s;
+				--n;
+				if (escape.size() > 2 and c >= 0x40)
+				{
+					sequence();
+					escape.clear();
+				}
+			}
+			else
+			{
+				// Not a control sequence, so it is output unchanged
+				pending();
+				put(escape.data(), escape.size());
+				clean = false;
+				escape.clear();
+			}
+		}
+	}
+
+protected:
+	int overflow(const int c) override
+	{
+		if (c != traits_type::eof())
+		{
+			const char ch = c;
+			output(&ch, 1);
+		}
+		return failed ? traits_type::eof() : traits_type::not_eof(c);
+	}
+
+	streamsize xsputn(const char *s, const streamsize n) override
+	{
+		output(s, n);
+		return failed ? 0 : n;
+	}
+
+	int sync() override
+	{
+		pending();
+		return write() ? 0 : -1;
+	}
+
+public:
+	outputbuf(ostream &strm, const int fd) : strm(strm), original(strm.rdbuf(this)), fd(fd), buffer(1 << 20) {}
+
+	~outputbuf()
+	{
+		put(escape.data(), escape.size());
+		sync();
+		strm.rdbuf(original);
+	}
+};
+
+// Number of allocations, counted by the replaced global operator new with --profile
+atomic<size_t> allocations(0);
+bool countallocations = false;
+
+// The replaced operators allocate with malloc() and free with free(), which GCC would report as mismatched wherever they are inlined
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(size_t size)
+{
+	if (countallocations)
+		allocations.fetch_add(1, memory_order_relaxed);
+	if (void *const ptr = malloc(size ? size : 1))
+		return ptr;
+	throw bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+// Used by std::stable_sort() for its temporary buffer
+void *operator new(size_t size, const nothrow_t &) noexcept
+{
+	if (countallocations)
+		allocations.fetch_add(1, memory_order_relaxed);
+	return malloc(size ? size : 1);
+}
+
+void operator delete(void *ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+// Number of bytes read from the inputs
+atomic<size_t> bytesread(0);
+
+// Set when an input could not be read or decompressed, so that the program exits with an error
+atomic<bool> readerror(false);
+
+// Time of each phase of the program and throughput, output to standard error with --profile
+class profiler
+{
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	chrono::steady_clock::time_point last = start;
+	vector<pair<const char *, double>> phases;
+
+public:
+	bool enabled = false;
+	profile_type format = profile_text;
+	size_t rows = 0;
+	size_t cells = 0;
+
+	// Record the time since the end of the previous phase
+	void phase(const char *const name)
+	{
+		const auto now = chrono::steady_clock::now();
+		phases.emplace_back(name, chrono::duration<double>(now - last).count());
+		last = now;
+	}
+
+	// The last phase writes the buffered output
+	~profiler()
+	{
+		if (!enabled)
+			return;
+
+		cout.flush();
+		phase("write");
+
+		const double total = chrono::duration<double>(last - start).count();
+		const size_t bytes = bytesread;
+
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		const size_t rss = usage.ru_maxrss * 1024;
+
+		ostringstream strm;
+		if (format == profile_json)
+		{
+			strm << "{\"phases\": {";
+			for (size_t i = 0; i < phases.size(); ++i)
+				strm << (i ? ", " : "") << '"' << phases[i].first << "\": " << phases[i].second;
+			strm << "}, \"total\": " << total << ", \"bytes\": " << bytes << ", \"rows\": " << rows << ", \"cells\": " << cells << ", \"allocations\": " << allocations << ", \"peak_rss\": " << rss << "}\n";
+		}
+		else
+		{
+			strm << "Profile:\n";
+			for (const auto &[name, time] : phases)
+				strm << "    " << left << setw(12) << name << right << setw(12) << fixed << setprecision(6) << time << " s (" << setw(5) << setprecision(1) << (total > 0 ? time / total * 100 : 0) << "%)\n";
+			strm << "    " << left << setw(12) << "total" << right << setw(12) << setprecision(6) << total << " s\n";
+			strm << defaultfloat << setprecision(4);
+			strm << "Bytes read:  " << bytes << " (" << (total > 0 ? bytes / total / 1e6 : 0) << " MB/s)\n";
+			strm << "Rows:        " << rows << " (" << (total > 0 ? rows / total : 0) << " rows/s)\n";
+			strm << "Cells:       " << cells << " (" << (total > 0 ? cells / total : 0) << " cells/s)\n";
+			strm << "Allocations: " << allocations << '\n';
+			strm << "Peak RSS:    " << rss << " bytes\n";
+		}
+		cerr << strm.str();
+	}
+};
+
+template <typename T>
+vector<basic_string<T>> split(const basic_string<T> &s, const T delim = ',')
+{
+	basic_istringstream<T> ss(s);
+	basic_string<T> item;
+	vector<basic_string<T>> result;
+
+	while (getline(ss, item, delim))
+	{
+		result.push_back(item);
+	}
+
+	return result;
+}
+
+// Bit masks of a block of 64 bytes, with a bit set for each quote, delimiter (field or line) and line delimiter
+struct masks
+{
+	uint64_t quotes;
+	uint64_t breaks;
+	uint64_t lines;
+};
+
+// Fields to keep from each row, from a list of fields and ranges of fields like cut -f (e.g. 1,3,7-9 or 5-)
+// The fields are numbered from 1 in the list and from 0 otherwise. All fields are kept by default.
+class selection
+{
+	vector<bool> fields;
+	// All fields from this one on are kept
+	size_t from = 0;
+
+public:
+	// Keep only the fields in list, returns false if it is not valid
+	bool parse(const string &list);
+
+	bool all() const { return !from; }
+
+	// Check if field i is kept
+	bool operator[](const size_t i) const { return i >= from or (i < fields.size() and fields[i]); }
+
+	// Get the number of fields after which none are kept, or SIZE_MAX if there is no such field
+	size_t end() const { return from == SIZE_MAX ? fields.size() : SIZE_MAX; }
+};
+
+bool selection::parse(const string &list)
+{
+	fields.clear();
+	from = SIZE_MAX;
+
+	const vector<string> tokens = split(list);
+	if (tokens.empty())
+		return false;
+
+	for (const auto &token : tokens)
+	{
+		const char *p = token.c_str();
+		char *q;
+		errno = 0;
+
+		size_t first = 1;
+		if (isdigit(*p))
+		{
+			first = strtoul(p, &q, 10);
+			p = q;
+		}
+		size_t last = first;
+		if (*p == '-')
+		{
+			++p;
+			last = SIZE_MAX;
+			if (isdigit(*p))
+			{
+				last = strtoul(p, &q, 10);
+				p = q;
+			}
+		}
+
+		if (*p or token.empty() or token == "-" or !first or first > last or errno == ERANGE)
+			return false;
+
+		if (last == SIZE_MAX)
+			from = min(from, first - 1);
+		else
+		{
+			if (fields.size() < last)
+				fields.resize(last);
+			fill(fields.begin() + (first - 1), fields.begin() + last, true);
+		}
+	}
+
+	if (from != SIZE_MAX)
+		fields.resize(min(fields.size(), from));
+
+	return true;
+}
+
+// Field and line delimiters
+// The function to find the next delimiter is selected at runtime for the CPU, so that it can check 16, 32 or 64 bytes at a time with SIMD instructions.
+class delimiters
+{
+	using find_type = const char *(*)(const char *, const char *, const delimiters &);
+	using scan_type = masks (*)(const char *, const delimiters &);
+	find_type afind;
+	scan_type ascan;
+
+public:
+	// Most delimiters that are checked with SIMD instructions
+	static constexpr size_t max_chars = 16;
+
+	bool table[256] = {};
+	alignas(16) char chars[max_chars] = {};
+	int count = 0;
+	const bool whitespace;
+	const char line_delim;
+	// Fields can be quoted, as in CSV and TSV files
+	const bool quoted;
+	// Fields to keep, the others are skipped
+	const selection fields;
+
+	delimiters(const char *delimiter, char line_delim, bool quoted = false, selection fields = {});
+
+	// Find the first delimiter in [first, last), or last if there is none
+	const char *find(const char *first, const char *last) const { return afind(first, last, *this); }
+
+	// Get the masks of the 64 bytes at block
+	masks scan(const char *block) const { return ascan(block, *this); }
+};
+
+const char *find_scalar(const char *first, const char *last, const delimiters &set)
+{
+	for (; first < last; ++first)
+		if (set.table[static_cast<unsigned char>(*first)])
+			return first;
+
+	return last;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse4.2"))) const char *find_sse42(const char *first, const char *last, const delimiters &set)
+{
+	const __m128i aset = _mm_load_si128(reinterpret_cast<const __m128i *>(set.chars));
+
+	for (; last - first >= 16; first += 16)
+	{
+		const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+		const int index = _mm_cmpestri(aset, set.count, block, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+		if (index < 16)
+			return first + index;
+	}
+
+	return find_scalar(first, last, set);
+}
+
+__attribute__((target("avx2"))) const char *find_avx2(const char *first, const char *last, const delimiters &set)
+{
+	__m256i aset[delimiters::max_chars];
+	for (int i = 0; i < set.count; ++i)
+		aset[i] = _mm256_set1_epi8(set.chars[i]);
+
+	for (; last - first >= 32; first += 32)
+	{
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+		__m256i match = _mm256_cmpeq_epi8(block, aset[0]);
+		for (int i = 1; i < set.count; ++i)
+			match = _mm256_or_si256(match, _mm256_cmpeq_epi8(block, aset[i]));
+		const unsigned mask = _mm256_movemask_epi8(match);
+		if (mask)
+			return first + __builtin_ctz(mask);
+	}
+
+	return find_scalar(first, last, set);
+}
+
+__attribute__((target("avx512bw"))) const char *find_avx512(const char *first, const char *last, const delimiters &set)
+{
+	__m512i aset[delimiters::max_chars];
+	for (int i = 0; i < set.count; ++i)
+		aset[i] = _mm512_set1_epi8(set.chars[i]);
+
+	for (; last - first >= 64; first += 64)
+	{
+		const __m512i block = _mm512_loadu_si512(first);
+		__mmask64 mask = 0;
+		for (int i = 0; i < set.count; ++i)
+			mask |= _mm512_cmpeq_epi8_mask(block, aset[i]);
+		if (mask)
+			return first + __builtin_ctzll(mask);
+	}
+
+	return find_scalar(first, last, set);
+}
+#endif
+
+masks scan_scalar(const char *block, const delimiters &set)
+{
+	masks amasks{};
+
+	for (unsigned i = 0; i < 64; ++i)
+	{
+		amasks.quotes |= static_cast<uint64_t>(block[i] == '"') << i;
+		amasks.breaks |= static_cast<uint64_t>(set.table[static_cast<unsigned char>(block[i])]) << i;
+		amasks.lines |= static_cast<uint64_t>(block[i] == set.line_delim) << i;
+	}
+
+	return amasks;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2"))) masks scan_sse2(const char *block, const delimiters &set)
+{
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i line = _mm_set1_epi8(set.line_delim);
+	masks amasks{};
+
+	for (unsigned i = 0; i < 64; i += 16)
+	{
+		const __m128i ablock = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i));
+		__m128i match = _mm_setzero_si128();
+		for (int j = 0; j < set.count; ++j)
+			match = _mm_or_si128(match, _mm_cmpeq_epi8(ablock, _mm_set1_epi8(set.chars[j])));
+		amasks.quotes |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(ablock, quote)))) << i;
+		amasks.breaks |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(match))) << i;
+		amasks.lines |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(ablock, line)))) << i;
+	}
+
+	return amasks;
+}
+
+__attribute__((target("avx2"))) masks scan_avx2(const char *block, const delimiters &set)
+{
+	const __m256i quote = _mm256_set1_epi8('"');
+	const __m256i line = _mm256_set1_epi8(set.line_delim);
+	masks amasks{};
+
+	for (unsigned i = 0; i < 64; i += 32)
+	{
+		const __m256i ablock = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + i));
+		__m256i match = _mm256_setzero_si256();
+		for (int j = 0; j < set.count; ++j)
+			match = _mm256_or_si256(match, _mm256_cmpeq_epi8(ablock, _mm256_set1_epi8(set.chars[j])));
+		amasks.quotes |= static_cast<uint64_t>(static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(ablock, quote)))) << i;
+		amasks.breaks |= static_cast<uint64_t>(static_cast<unsigned>(_mm256_movemask_epi8(match))) << i;
+		amasks.lines |= static_cast<uint64_t>(static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(ablock, line)))) << i;
+	}
+
+	return amasks;
+}
+
+__attribute__((target("avx512bw"))) masks scan_avx512(const char *block, const delimiters &set)
+{
+	const __m512i ablock = _mm512_loadu_si512(block);
+	masks amasks{};
+
+	for (int j = 0; j < set.count; ++j)
+		amasks.breaks |= _mm512_cmpeq_epi8_mask(ablock, _mm512_set1_epi8(set.chars[j]));
+	amasks.quotes = _mm512_cmpeq_epi8_mask(ablock, _mm512_set1_epi8('"'));
+	amasks.lines = _mm512_cmpeq_epi8_mask(ablock, _mm512_set1_epi8(set.line_delim));
+
+	return amasks;
+}
+#endif
+
+delimiters::delimiters(const char *delimiter, const char line_delim, const bool quoted, selection fields) : whitespace(!delimiter), line_delim(line_delim), quoted(quoted), fields(move(fields))
+{
+	// Same characters as isspace() in the "C" locale, which operator>> uses to skip whitespace
+	const char *const chars = whitespace ? " \t\n\v\f\r" : delimiter;
+
+	table[static_cast<unsigned char>(line_delim)] = true;
+	for (const char *c = chars; *c; ++c)
+		table[static_cast<unsigned char>(*c)] = true;
+
+	bool simd = true;
+	for (size_t i = 0; i < size(table); ++i)
+	{
+		if (table[i])
+		{
+			if (count < static_cast<int>(max_chars))
+				this->chars[count++] = static_cast<char>(i);
+			else
+				simd = false;
+		}
+	}
+
+	static const find_type best = []
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512bw"))
+			return find_avx512;
+		if (__builtin_cpu_supports("avx2"))
+			return find_avx2;
+		if (__builtin_cpu_supports("sse4.2"))
+			return find_sse42;
+#endif
+		return find_scalar;
+	}();
+
+	static const scan_type bestscan = []
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512bw"))
+			return scan_avx512;
+		if (__builtin_cpu_supports("avx2"))
+			return scan_avx2;
+		if (__builtin_cpu_supports("sse2"))
+			return scan_sse2;
+#endif
+		return scan_scalar;
+	}();
+
+	afind = simd ? best : find_scalar;
+	ascan = simd ? bestscan : scan_scalar;
+}
+
+// Split a line into cells, skipping the fields that are not selected
+template <typename T>
+void tokenize(const basic_string_view<T> &line, const delimiters &adelimiters, vector<basic_string_view<T>> &array)
+{
+	const selection &fields = adelimiters.fields;
+	const size_t last = fields.end();
+	const T *p = line.data();
+	const T *const end = p + line.size();
+
+	if (adelimiters.whitespace)
+	{
+		for (size_t i = 0; i < last; ++i)
+		{
+			while (p < end and adelimiters.table[static_cast<unsigned char>(*p)])
+				++p;
+			if (p == end)
+				break;
+			const T *const q = adelimiters.find(p, end);
+			if (fields[i])
+				array.emplace_back(p, q - p);
+			p = q;
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < last; ++i)
+		{
+			const T *const q = adelimiters.find(p, end);
+			if (fields[i])
+				array.emplace_back(p, q - p);
+			if (q == end)
+				break;
+			p = q + 1;
+		}
+	}
+}
+
+// Set each bit if there is an odd number of set bits up to and including it
+inline uint64_t prefix_xor(uint64_t x)
+{
+	x ^= x << 1;
+	x ^= x << 2;
+	x ^= x << 4;
+	x ^= x << 8;
+	x ^= x << 16;
+	x ^= x << 32;
+	return x;
+}
+
+// Call function(fields) with the fields of each record of a buffer of CSV or TSV records (RFC 4180)
+// The buffer is processed 64 bytes at a time, like simdcsv: the quotes, delimiters and line delimiters of each block are found as bit masks, a prefix XOR of the quotes gives the bytes that are inside quoted fields and the delimiters that are left are the ends of the fields, so there is no branch for each byte. Field and line delimiters inside quotes are part of the field. The fields still have their quotes, which unquote() removes. A carriage return before the line delimiter is removed. Returns false if the buffer ends inside a quoted field.
+template <typename F>
+bool records(const string_view &buffer, const delimiters &adelimiters, vector<string_view> &fields, const F &function)
+{
+	const char *const data = buffer.data();
+	const size_t size = buffer.size();
+	const bool crlf = adelimiters.line_delim == '\n';
+
+	auto record = [&]()
+	{
+		string_view &field = fields.back();
+		if (crlf and !field.empty() and field.back() == '\r')
+			field.remove_suffix(1);
+		function(fields);
+		fields.clear();
+	};
+
+	// All ones if the previous block ended inside quotes
+	uint64_t inside = 0;
+	size_t start = 0;
+	char last[64] = {};
+
+	for (size_t i = 0; i < size; i += 64)
+	{
+		const size_t n = min(size - i, size_t(64));
+		const char *block = data + i;
+		if (n < 64)
+		{
+			memcpy(last, block, n);
+			block = last;
+		}
+
+		masks amasks = adelimiters.scan(block);
+		if (n < 64)
+		{
+			const uint64_t valid = (uint64_t(1) << n) - 1;
+			amasks.quotes &= valid;
+			amasks.breaks &= valid;
+		}
+
+		const uint64_t quoted = prefix_xor(amasks.quotes) ^ inside;
+		inside = static_cast<uint64_t>(static_cast<int64_t>(quoted) >> 63);
+
+		for (uint64_t breaks = amasks.breaks & ~quoted; breaks; breaks &= breaks - 1)
+		{
+			const unsigned bit = __builtin_ctzll(breaks);
+			const size_t end = i + bit;
+
+			fields.emplace_back(data + start, end - start);
+			start = end + 1;
+
+			if ((amasks.lines >> bit) & 1)
+				record();
+		}
+	}
+
+	if (start < size or !fields.empty())
+	{
+		fields.emplace_back(data + start, size - start);
+		record();
+	}
+
+	return !inside;
+}
+
+// Remove the quotes around a quoted field
+// Returns false if it has escaped quotes (""), which unescape() must then replace in a copy of the field. Fields that are not entirely quoted are used as is.
+bool unquote(string_view &field)
+{
+	if (field.size() < 2 or field.front() != '"' or field.back() != '"')
+		return true;
+
+	field = field.substr(1, field.size() - 2);
+
+	return field.find('"') == string_view::npos;
+}
+
+// Replace each escaped quote ("") with one quote
+string unescape(const string_view &field)
+{
+	string str;
+	str.reserve(field.size());
+
+	for (size_t i = 0; i < field.size(); ++i)
+	{
+		str += field[i];
+		if (field[i] == '"' and i + 1 < field.size() and field[i + 1] == '"')
+			++i;
+	}
+
+	return str;
+}
+
+// Split a CSV or TSV record into cells, skipping the fields that are not selected
+// The cells with escaped quotes are copied into escaped, which they are then views into.
+void tokenize(const string_view &record, const delimiters &adelimiters, vector<string_view> &array, list<string> &escaped)
+{
+	vector<string_view> fields;
+
+	records(record, adelimiters, fields, [&](const vector<string_view> &afields)
+			{
+		for (size_t i = 0; i < afields.size(); ++i)
+		{
+			if (!adelimiters.fields[i])
+				continue;
+			string_view field = afields[i];
+			if (!unquote(field))
+				field = escaped.emplace_back(unescape(field));
+			array.push_back(field);
+		} });
+}
+
+// Rows of cells, with the cells of all the rows in one vector and the index of the first cell of each row, instead of a vector for each row
+// Parsing then only allocates when the two vectors grow, and there is nothing to free for each row. The rows are views, which are used like the vectors of cells they replace, including by tables::array().
+template <typename T>
+class cellarray
+{
+	vector<T> cells;
+	// Index of the first cell of each row, then the number of cells
+	vector<size_t> offsets = {0};
+
+public:
+	// View of the cells of a row
+	class row
+	{
+		const T *first = nullptr;
+		const T *last = nullptr;
+
+	public:
+		using value_type = T;
+		using const_iterator = const T *;
+		using iterator = const T *;
+
+		row() = default;
+		row(const T *first, const T *last) : first(first), last(last) {}
+
+		const T *begin() const { return first; }
+		const T *end() const { return last; }
+		const T *cbegin() const { return first; }
+		const T *cend() const { return last; }
+		size_t size() const { return last - first; }
+		bool empty() const { return first == last; }
+		const T &operator[](const size_t i) const { return first[i]; }
+	};
+
+	// Iterator over the rows, which keeps the view of the current row, so that it can be used by reference
+	class const_iterator
+	{
+		const cellarray *array;
+		size_t i;
+		mutable row arow;
+
+	public:
+		using iterator_category = input_iterator_tag;
+		using value_type = row;
+		using difference_type = ptrdiff_t;
+		using pointer = const row *;
+		using reference = const row &;
+
+		const_iterator(const cellarray *array, const size_t i) : array(array), i(i) {}
+
+		const row &operator*() const
+		{
+			arow = (*array)[i];
+			return arow;
+		}
+		const_iterator &operator++()
+		{
+			++i;
+			return *this;
+		}
+		bool operator==(const const_iterator &other) const { return i == other.i; }
+		bool operator!=(const const_iterator &other) const { return i != other.i; }
+	};
+
+	using value_type = row;
+	using iterator = const_iterator;
+
+	size_t size() const { return offsets.size() - 1; }
+	bool empty() const { return offsets.size() == 1; }
+	row operator[](const size_t i) const { return {cells.data() + offsets[i], cells.data() + offsets[i + 1]}; }
+	const_iterator begin() const { return {this, 0}; }
+	const_iterator end() const { return {this, size()}; }
+	const_iterator cbegin() const { return begin(); }
+	const_iterator cend() const { return end(); }
+
+	// Total number of cells
+	size_t count() const { return cells.size(); }
+
+	void reserve(const size_t rows, const size_t acells)
+	{
+		offsets.reserve(rows + 1);
+		cells.reserve(acells);
+	}
+
+	// Add a cell to the last row, which is not finished until endrow() is called
+	template <typename... Args>
+	void add(Args &&...args) { cells.emplace_back(forward<Args>(args)...); }
+
+	// Finish the last row, so that the next cells are added to a new row
+	void endrow() { offsets.push_back(cells.size()); }
+
+	// Add the rows of another array after the rows of this one
+	void append(cellarray &&other)
+	{
+		if (empty())
+			*this = move(other);
+		else
+			append(other);
+	}
+
+	void append(const cellarray &other)
+	{
+		const size_t start = cells.size();
+		cells.insert(cells.end(), other.cells.cbegin(), other.cells.cend());
+		offsets.reserve(offsets.size() + other.size());
+		for (size_t i = 1; i < other.offsets.size(); ++i)
+			offsets.push_back(start + other.offsets[i]);
+	}
+
+	// Remove the rows in [first, last)
+	void erase(const size_t first, const size_t last)
+	{
+		const size_t start = offsets[first];
+		const size_t end = offsets[last];
+		cells.erase(cells.begin() + start, cells.begin() + end);
+		offsets.erase(offsets.begin() + first + 1, offsets.begin() + last + 1);
+		for (size_t i = first + 1; i < offsets.size(); ++i)
+			offsets[i] -= end - start;
+	}
+
+	// Replace each cell with function(j, cell), where j is its column
+	template <typename F>
+	void update(const F &function)
+	{
+		for (size_t i = 0; i < size(); ++i)
+			for (size_t k = offsets[i]; k < offsets[i + 1]; ++k)
+				cells[k] = function(k - offsets[i], cells[k]);
+	}
+
+	// Reorder the rows from first on, so that row first + i is the row first + order[i]
+	void reorder(const size_t first, const vector<size_t> &order)
+	{
+		vector<T> acells;
+		acells.reserve(cells.size());
+		acells.insert(acells.end(), cells.cbegin(), cells.cbegin() + offsets[first]);
+
+		vector<size_t> aoffsets(offsets.cbegin(), offsets.cbegin() + first + 1);
+		aoffsets.reserve(offsets.size());
+		for (const size_t i : order)
+		{
+			acells.insert(acells.end(), cells.cbegin() + offsets[first + i], cells.cbegin() + offsets[first + i + 1]);
+			aoffsets.push_back(acells.size());
+		}
+
+		cells = move(acells);
+		offsets = move(aoffsets);
+	}
+
+	// Add empty cells to the end of each row that has fewer than columns cells, which is the most of any row
+	void pad(const size_t columns)
+	{
+		if (cells.size() == size() * columns)
+			return;
+
+		vector<T> acells(size() * columns);
+		for (size_t i = 0; i < size(); ++i)
+		{
+			copy(cells.cbegin() + offsets[i], cells.cbegin() + offsets[i + 1], acells.begin() + (i * columns));
+			offsets[i] = i * columns;
+		}
+		offsets.back() = acells.size();
+		cells = move(acells);
+	}
+};
+
+// Split a buffer of whole lines into rows
+// The fields that are not selected are skipped, as is the rest of each line after the last selected field.
+template <typename T>
+cellarray<basic_string_view<T>> parse(const basic_string_view<T> &buffer, const delimiters &adelimiters, const bool keep_empty_lines)
+{
+	cellarray<basic_string_view<T>> aarray;
+	const char line_delim = adelimiters.line_delim;
+	const selection &fields = adelimiters.fields;
+	const size_t last = fields.end();
+
+	// Find the field and line delimiters in a single pass over the buffer
+	const T *p = buffer.data();
+	const T *const end = p + buffer.size();
+	while (p < end)
+	{
+		if (*p == line_delim)
+		{
+			if (keep_empty_lines)
+				aarray.endrow();
+			++p;
+			continue;
+		}
+
+		if (adelimiters.whitespace)
+		{
+			for (size_t i = 0;; ++i)
+			{
+				while (p < end and *p != line_delim and adelimiters.table[static_cast<unsigned char>(*p)])
+					++p;
+				if (p == end)
+					break;
+				if (*p == line_delim or i == last)
+				{
+					p = min(find(p, end, line_delim) + 1, end);
+					break;
+				}
+				const T *const q = adelimiters.find(p, end);
+				if (fields[i])
+					aarray.add(p, q - p);
+				p = q;
+			}
+		}
+		else
+		{
+			for (size_t i = 0;; ++i)
+			{
+				const T *q = adelimiters.find(p, end);
+				if (fields[i])
+					aarray.add(p, q - p);
+				if (i + 1 == last and q != end and *q != line_delim)
+					q = find(q, end, line_delim);
+				if (q == end)
+				{
+					p = end;
+					break;
+				}
+				p = q + 1;
+				if (*q == line_delim)
+					break;
+			}
+		}
+
+		aarray.endrow();
+	}
+
+	return aarray;
+}
+
+// Split a buffer of whole CSV or TSV records into rows
+// The cells with escaped quotes are copied into escaped, which they are then views into.
+cellarray<string_view> parse(const string_view &buffer, const delimiters &adelimiters, const bool keep_empty_lines, list<string> &escaped)
+{
+	cellarray<string_view> aarray;
+	vector<string_view> fields;
+
+	const bool terminated = records(buffer, adelimiters, fields, [&](const vector<string_view> &afields)
+									{
+		if (afields.size() == 1 and afields[0].empty())
+		{
+			if (keep_empty_lines)
+				aarray.endrow();
+			return;
+		}
+
+		for (size_t i = 0; i < afields.size(); ++i)
+		{
+			if (!adelimiters.fields[i])
+				continue;
+			string_view field = afields[i];
+			if (!unquote(field))
+				field = escaped.emplace_back(unescape(field));
+			aarray.add(field);
+		}
+		aarray.endrow(); });
+
+	if (!terminated)
+		cerr << "Warning: The input ends inside a quoted field.\n";
+
+	return aarray;
+}
+
+// Call function(i) for each i in [0, n), using up to jobs threads
+template <typename F>
+void parallel(const size_t n, const unsigned jobs, const F &function)
+{
+	atomic<size_t> next = 0;
+
+	auto worker = [&]()
+	{
+		for (size_t i; (i = next++) < n;)
+			function(i);
+	};
+
+	vector<thread> threads;
+	for (size_t i = 1; i < min(static_cast<size_t>(jobs), n); ++i)
+		threads.emplace_back(worker);
+
+	worker();
+
+	for (auto &athread : threads)
+		athread.join();
+}
+
+// Split the buffer into up to jobs chunks of at least 1 MiB, which each end after a line delimiter
+template <typename T>
+vector<basic_string_view<T>> chunk(const basic_string_view<T> &buffer, const char line_delim, const unsigned jobs)
+{
+	const size_t n = max(min(static_cast<size_t>(jobs), buffer.size() >> 20), size_t(1));
+
+	vector<basic_string_view<T>> chunks;
+	chunks.reserve(n);
+
+	size_t start = 0;
+	for (size_t i = 1; i <= n and start < buffer.size(); ++i)
+	{
+		size_t end = buffer.size();
+		if (i < n)
+		{
+			end = buffer.find(line_delim, max(start, (buffer.size() / n) * i));
+			end = end != basic_string_view<T>::npos ? end + 1 : buffer.size();
+		}
+
+		chunks.push_back(buffer.substr(start, end - start));
+		start = end;
+	}
+
+	return chunks;
+}
+
+// Split a buffer of CSV or TSV records into chunks like chunk(), then move the end of each chunk that is inside a quoted field to the end of its record
+// The quotes of the chunks are counted in parallel first, so that whether each chunk ends inside quotes is known without parsing the chunks before it.
+vector<string_view> csvchunk(const string_view &buffer, const char line_delim, const unsigned jobs)
+{
+	const vector<string_view> chunks = chunk(buffer, line_delim, jobs);
+
+	if (chunks.size() <= 1)
+		return chunks;
+
+	vector<size_t> quotes(chunks.size());
+
+	parallel(chunks.size(), jobs, [&](const size_t i)
+			 { quotes[i] = count(chunks[i].cbegin(), chunks[i].cend(), '"'); });
+
+	vector<string_view> achunks;
+	achunks.reserve(chunks.size());
+
+	const char *start = buffer.data();
+	const char *const end = start + buffer.size();
+	size_t total = 0;
+	for (size_t i = 0; i < chunks.size(); ++i)
+	{
+		total += quotes[i];
+
+		const char *p = chunks[i].data() + chunks[i].size();
+		// The previous chunk was extended past the end of this one
+		if (p <= start)
+			continue;
+
+		if (total & 1)
+		{
+			for (bool inside = true; p < end; ++p)
+			{
+				if (*p == '"')
+					inside = !inside;
+				else if (*p == line_delim and !inside)
+				{
+					++p;
+					break;
+				}
+			}
+		}
+
+		achunks.emplace_back(start, p - start);
+		start = p;
+	}
+
+	return achunks;
+}
+
+// Parse each chunk of the buffer on its own thread, then join their rows in order
+// With quoted fields, the cells with escaped quotes are copied into escaped, which they are then views into.
+template <typename T>
+cellarray<basic_string_view<T>> input(const basic_string_view<T> &buffer, const char *delimiter, const char line_delim, const bool quoted, const selection &fields, const bool keep_empty_lines, const unsigned jobs, list<basic_string<T>> &escaped)
+{
+	const delimiters adelimiters(delimiter, line_delim, quoted, fields);
+	const vector<basic_string_view<T>> chunks = quoted ? csvchunk(buffer, line_delim, jobs) : chunk(buffer, line_delim, jobs);
+
+	bytesread += buffer.size();
+
+	if (chunks.size() <= 1)
+		return quoted ? parse(buffer, adelimiters, keep_empty_lines, escaped) : parse(buffer, adelimiters, keep_empty_lines);
+
+	vector<cellarray<basic_string_view<T>>> aaarray(chunks.size());
+	vector<list<basic_string<T>>> aescaped(chunks.size());
+
+	parallel(chunks.size(), jobs, [&](const size_t i)
+			 { aaarray[i] = quoted ? parse(chunks[i], adelimiters, keep_empty_lines, aescaped[i]) : parse(chunks[i], adelimiters, keep_empty_lines); });
+
+	for (auto &temp : aescaped)
+		escaped.splice(escaped.end(), temp);
+
+	cellarray<basic_string_view<T>> aarray = move(aaarray[0]);
+
+	size_t rows = 0;
+	size_t cells = 0;
+	for (const auto &array : aaarray)
+	{
+		rows += array.size();
+		cells += array.count();
+	}
+	aarray.reserve(rows, cells);
+
+	for (size_t i = 1; i < aaarray.size(); ++i)
+	{
+		aarray.append(aaarray[i]);
+		aaarray[i] = {};
+	}
+
+	return aarray;
+}
+
+// Copies of the cells of an input that is read, so that its blocks can be freed once they are parsed
+// The repeated values of each column (e.g. the owner or status) share one copy. A column stops being interned once most of its values are distinct, and its cells are then just copied, so that it does not keep a large hash table.
+class interner
+{
+	// Number of cells of a column between the checks of its number of distinct values
+	static constexpr size_t sample = 1 << 12;
+	static constexpr size_t block = 1 << 16;
+
+	struct column
+	{
+		unordered_set<string_view> values;
+		size_t cells = 0;
+		bool interned = true;
+	};
+
+	vector<column> columns;
+	// Blocks that the values are copied into, which are never reallocated, so that the views into them stay valid
+	list<string> &blocks;
+
+	string_view copy(const string_view &value)
+	{
+		if (blocks.empty() or blocks.back().capacity() - blocks.back().size() < value.size())
+			blocks.emplace_back().reserve(max(value.size(), block));
+
+		string &ablock = blocks.back();
+		const size_t start = ablock.size();
+		ablock.append(value);
+		return string_view(ablock).substr(start);
+	}
+
+public:
+	explicit interner(list<string> &blocks) : blocks(blocks) {}
+
+	string_view intern(const size_t j, const string_view &value)
+	{
+		if (value.empty())
+			return {};
+
+		if (j >= columns.size())
+			columns.resize(j + 1);
+
+		column &acolumn = columns[j];
+		if (!acolumn.interned)
+			return copy(value);
+
+		auto iter = acolumn.values.find(value);
+		if (iter == acolumn.values.end())
+			iter = acolumn.values.insert(copy(value)).first;
+		const string_view avalue = *iter;
+
+		if (++acolumn.cells % sample == 0 and acolumn.values.size() > acolumn.cells / 2)
+		{
+			acolumn.interned = false;
+			acolumn.values = {};
+		}
+
+		return avalue;
+	}
+};
+
+// Compression formats of the inputs, which are detected from their magic bytes
+enum compression_type
+{
+	compression_none,
+	compression_gzip,
+	compression_zstd,
+	compression_xz
+};
+
+const string_view compression_magics[] = {{}, {"\x1F\x8B\x08", 3}, {"\x28\xB5\x2F\xFD", 4}, {"\xFD\x37\x7A\x58\x5A\x00", 6}};
+
+// Get the compression format of data from its magic bytes
+compression_type compression(const string_view &data)
+{
+	for (size_t i = 1; i < size(compression_magics); ++i)
+		if (data.substr(0, compression_magics[i].size()) == compression_magics[i])
+			return static_cast<compression_type>(i);
+
+	return compression_none;
+}
+
+// The decompression libraries are loaded at runtime, so that they are only required to read compressed inputs
+// Only the parts of their stable C interfaces that are used are declared.
+void *load(const char *const library)
+{
+	void *const handle = dlopen(library, RTLD_NOW | RTLD_LOCAL);
+	if (!handle)
+		cerr << "Error: Unable to load the " << library << " library to decompress the input (" << dlerror() << ").\n";
+
+	return handle;
+}
+
+template <typename T>
+bool symbol(void *const handle, const char *const name, T &function)
+{
+	function = reinterpret_cast<T>(dlsym(handle, name));
+	if (!function)
+		cerr << "Error: Unable to load the " << name << " function to decompress the input (" << dlerror() << ").\n";
+
+	return function;
+}
+
+// Each codec decompresses from [in, in + inlen) to [out, out + outlen), advancing both, where finish is true if there is no more input
+// Returns 1 at the end of a stream, 0 to continue or -1 on an error, with the message in error.
+
+// gzip and zlib streams, with zlib
+class gzip_codec
+{
+	// Same layout as in zlib.h
+	struct z_stream
+	{
+		const unsigned char *next_in;
+		unsigned avail_in;
+		unsigned long total_in;
+		unsigned char *next_out;
+		unsigned avail_out;
+		unsigned long total_out;
+		const char *msg;
+		void *state;
+		void *zalloc;
+		void *zfree;
+		void *opaque;
+		int data_type;
+		unsigned long adler;
+		unsigned long reserved;
+	};
+
+	static inline const char *(*zlibVersion)();
+	static inline int (*inflateInit2_)(z_stream *, int, const char *, int);
+	static inline int (*inflate)(z_stream *, int);
+	static inline int (*inflateReset)(z_stream *);
+	static inline int (*inflateEnd)(z_stream *);
+
+	z_stream strm{};
+	bool initialized = false;
+	// A member ended, so the rest of the input is only another member if it starts with the gzip magic bytes
+	bool ended = false;
+	// The rest of the input after the last member (e.g. zero padding), which is ignored like gzip does
+	bool trailing = false;
+
+public:
+	static bool load()
+	{
+		static const bool loaded = []
+		{
+			void *const handle = ::load("libz.so.1");
+			return handle and symbol(handle, "zlibVersion", zlibVersion) and symbol(handle, "inflateInit2_", inflateInit2_) and symbol(handle, "inflate", inflate) and symbol(handle, "inflateReset", inflateReset) and symbol(handle, "inflateEnd", inflateEnd);
+		}();
+		return loaded;
+	}
+
+	~gzip_codec()
+	{
+		if (initialized)
+			inflateEnd(&strm);
+	}
+
+	int decompress(const char *&in, size_t &inlen, char *&out, size_t &outlen, bool, string &error)
+	{
+		if (ended and inlen)
+		{
+			trailing = static_cast<unsigned char>(in[0]) != 0x1F or (inlen > 1 and static_cast<unsigned char>(in[1]) != 0x8B);
+			ended = false;
+		}
+		if (trailing)
+		{
+			in += inlen;
+			inlen = 0;
+			return 1;
+		}
+
+		// Detect the gzip or zlib header
+		if (!initialized and inflateInit2_(&strm, 15 + 32, zlibVersion(), sizeof(strm)))
+		{
+			error = "inflateInit2";
+			return -1;
+		}
+		initialized = true;
+
+		strm.next_in = reinterpret_cast<const unsigned char *>(in);
+		strm.avail_in = min(inlen, size_t(UINT_MAX));
+		strm.next_out = reinterpret_cast<unsigned char *>(out);
+		strm.avail_out = min(outlen, size_t(UINT_MAX));
+
+		const int code = inflate(&strm, 0);
+
+		const size_t used = reinterpret_cast<const char *>(strm.next_in) - in;
+		const size_t written = reinterpret_cast<char *>(strm.next_out) - out;
+		in += used;
+		inlen -= used;
+		out += written;
+		outlen -= written;
+
+		// No progress (Z_BUF_ERROR) is not an error by itself
+		if (code == 0 or code == -5)
+			return 0;
+		// The input can have multiple gzip members
+		if (code == 1)
+		{
+			inflateReset(&strm);
+			ended = true;
+			return 1;
+		}
+
+		error = strm.msg ? strm.msg : "inflate";
+		return -1;
+	}
+};
+
+// zstd streams, with libzstd
+class zstd_codec
+{
+	// Same layout as in zstd.h
+	struct ZSTD_inBuffer
+	{
+		const void *src;
+		size_t size;
+		size_t pos;
+	};
+
+	struct ZSTD_outBuffer
+	{
+		void *dst;
+		size_t size;
+		size_t pos;
+	};
+
+	static inline void *(*ZSTD_createDStream)();
+	static inline size_t (*ZSTD_freeDStream)(void *);
+	static inline size_t (*ZSTD_decompressStream)(void *, ZSTD_outBuffer *, ZSTD_inBuffer *);
+	static inline unsigned (*ZSTD_isError)(size_t);
+	static inline const char *(*ZSTD_getErrorName)(size_t);
+
+	void *const dstream = ZSTD_createDStream();
+
+public:
+	static bool load()
+	{
+		static const bool loaded = []
+		{
+			void *const handle = ::load("libzstd.so.1");
+			return handle and symbol(handle, "ZSTD_createDStream", ZSTD_createDStream) and symbol(handle, "ZSTD_freeDStream", ZSTD_freeDStream) and symbol(handle, "ZSTD_decompressStream", ZSTD_decompressStream) and symbol(handle, "ZSTD_isError", ZSTD_isError) and symbol(handle, "ZSTD_getErrorName", ZSTD_getErrorName);
+		}();
+		return loaded;
+	}
+
+	~zstd_codec() { ZSTD_freeDStream(dstream); }
+
+	int decompress(const char *&in, size_t &inlen, char *&out, size_t &outlen, bool, string &error)
+	{
+		if (!dstream)
+		{
+			error = "ZSTD_createDStream";
+			return -1;
+		}
+
+		ZSTD_inBuffer input = {in, inlen, 0};
+		ZSTD_outBuffer output = {out, outlen, 0};
+
+		// The next frame is started automatically
+		const size_t code = ZSTD_decompressStream(dstream, &output, &input);
+
+		in += input.pos;
+		inlen -= input.pos;
+		out += output.pos;
+		outlen -= output.pos;
+
+		if (ZSTD_isError(code))
+		{
+			error = ZSTD_getErrorName(code);
+			return -1;
+		}
+
+		// The frame has been completely decompressed and output
+		return !code;
+	}
+};
+
+// xz streams, with liblzma
+class xz_codec
+{
+	// Same layout as in lzma/base.h
+	struct lzma_stream
+	{
+		const uint8_t *next_in;
+		size_t avail_in;
+		uint64_t total_in;
+		uint8_t *next_out;
+		size_t avail_out;
+		uint64_t total_out;
+		const void *allocator;
+		void *internal;
+		void *reserved_ptr1;
+		void *reserved_ptr2;
+		void *reserved_ptr3;
+		void *reserved_ptr4;
+		uint64_t seek_pos;
+		uint64_t reserved_int2;
+		size_t reserved_int3;
+		size_t reserved_int4;
+		int reserved_enum1;
+		int reserved_enum2;
+	};
+
+	static inline int (*lzma_stream_decoder)(lzma_stream *, uint64_t, uint32_t);
+	static inline int (*lzma_code)(lzma_stream *, int);
+	static inline void (*lzma_end)(lzma_stream *);
+
+	lzma_stream strm{};
+	bool initialized = false;
+
+public:
+	static bool load()
+	{
+		static const bool loaded = []
+		{
+			void *const handle = ::load("liblzma.so.5");
+			return handle and symbol(handle, "lzma_stream_decoder", lzma_stream_decoder) and symbol(handle, "lzma_code", lzma_code) and symbol(handle, "lzma_end", lzma_end);
+		}();
+		return loaded;
+	}
+
+	~xz_codec()
+	{
+		if (initialized)
+			lzma_end(&strm);
+	}
+
+	int decompress(const char *&in, size_t &inlen, char *&out, size_t &outlen, const bool finish, string &error)
+	{
+		// No memory limit and LZMA_CONCATENATED, so that the input can have multiple xz streams
+		if (!initialized and lzma_stream_decoder(&strm, UINT64_MAX, 0x08))
+		{
+			error = "lzma_stream_decoder";
+			return -1;
+		}
+		initialized = true;
+
+		strm.next_in = reinterpret_cast<const uint8_t *>(in);
+		strm.avail_in = inlen;
+		strm.next_out = reinterpret_cast<uint8_t *>(out);
+		strm.avail_out = outlen;
+
+		// LZMA_RUN or LZMA_FINISH
+		const int code = lzma_code(&strm, finish ? 3 : 0);
+
+		const size_t used = reinterpret_cast<const char *>(strm.next_in) - in;
+		const size_t written = reinterpret_cast<char *>(strm.next_out) - out;
+		in += used;
+		inlen -= used;
+		out += written;
+		outlen -= written;
+
+		// No progress (LZMA_BUF_ERROR) is not an error by itself
+		if (code == 0 or code == 10)
+			return 0;
+		if (code == 1)
+			return 1;
+
+		error = "lzma_code error " + to_string(code);
+		return -1;
+	}
+};
+
+// Decompresses an input on its own thread, so that it overlaps with parsing
+// The decompressed blocks are passed through a queue of up to four blocks, so it uses a constant amount of memory.
+class decompressor
+{
+	static constexpr size_t block_size = 1 << 20;
+	static constexpr size_t queue_size = 4;
+
+	const int fd;
+	// Start of the input, which was already read to detect the compression format
+	string prefix;
+
+	mutex amutex;
+	condition_variable ready;
+	condition_variable space;
+	deque<string> blocks;
+	bool done = false;
+	bool stopped = false;
+	// The input could not be read or decompressed, so the blocks are only the start of it
+	bool failed = false;
+
+	thread athread;
+
+	bool push(string &&block)
+	{
+		unique_lock<mutex> lock(amutex);
+		space.wait(lock, [&]
+				   { return blocks.size() < queue_size or stopped; });
+		if (stopped)
+			return false;
+		blocks.push_back(move(block));
+		ready.notify_one();
+		return true;
+	}
+
+	// Decompress the input, returns false if it could not be read or decompressed
+	template <typename C>
+	bool run()
+	{
+		if (!C::load())
+			return false;
+
+		C acodec;
+		string error;
+
+		string input = move(prefix);
+		const char *in = input.data();
+		size_t inlen = input.size();
+		bool eof = false;
+
+		string block(block_size, '\0');
+		size_t size = 0;
+		// The last stream ended, with no more output since
+		bool end = false;
+		bool success = true;
+
+		for (;;)
+		{
+			if (!inlen and !eof)
+			{
+				input.resize(block_size);
+				const ssize_t n = read(fd, input.data(), input.size());
+				if (n == -1 and errno == EINTR)
+					continue;
+				if (n == -1)
+				{
+					cerr << "Error: Unable to read the input (" << strerror(errno) << ").\n";
+					success = false;
+					break;
+				}
+				in = input.data();
+				inlen = n;
+				eof = !n;
+			}
+
+			char *out = block.data() + size;
+			size_t outlen = block.size() - size;
+			const size_t before = inlen;
+			const int code = acodec.decompress(in, inlen, out, outlen, eof, error);
+			const bool progress = inlen != before or out != block.data() + size;
+			size = out - block.data();
+
+			if (code == -1)
+			{
+				cerr << "Error: Unable to decompress the input (" << error << ").\n";
+				success = false;
+				break;
+			}
+			if (code == 1 or progress)
+				end = code == 1;
+
+			if (size == block.size())
+			{
+				if (!push(move(block)))
+					return true;
+				block.assign(block_size, '\0');
+				size = 0;
+			}
+
+			if (eof and !inlen and (end or !progress))
+			{
+				if (!end)
+				{
+					cerr << "Error: Unable to decompress the input (unexpected end of input).\n";
+					success = false;
+				}
+				break;
+			}
+		}
+
+		// The output so far is used even after an error, except for its last line, which could be incomplete
+		block.resize(size);
+		if (!block.empty())
+			push(move(block));
+		return success;
+	}
+
+public:
+	decompressor(const int fd, const compression_type type, string prefix) : fd(fd), prefix(move(prefix))
+	{
+		athread = thread([this, type]
+						 {
+			bool success = false;
+			if (type == compression_gzip)
+				success = run<gzip_codec>();
+			else if (type == compression_zstd)
+				success = run<zstd_codec>();
+			else if (type == compression_xz)
+				success = run<xz_codec>();
+
+			lock_guard<mutex> lock(amutex);
+			failed = !success;
+			done = true;
+			ready.notify_one(); });
+	}
+
+	~decompressor()
+	{
+		{
+			lock_guard<mutex> lock(amutex);
+			stopped = true;
+			space.notify_one();
+		}
+		athread.join();
+	}
+
+	// Get the next decompressed block
+	// Returns 1, 0 at the end of the input or -1 after the last block if the input could not be decompressed.
+	int pop(string &block)
+	{
+		unique_lock<mutex> lock(amutex);
+		ready.wait(lock, [&]
+				   { return !blocks.empty() or done; });
+		if (blocks.empty())
+			return failed ? -1 : 0;
+		block = move(blocks.front());
+		blocks.pop_front();
+		space.notify_one();
+		return 1;
+	}
+};
+
+// Input from a file descriptor, which is decompressed on its own thread if it starts with the magic bytes of a gzip, zstd or xz stream
+class reader
+{
+	const int fd;
+	// Bytes read to detect the compression format
+	string prefix;
+	unique_ptr<decompressor> adecompressor;
+	string block;
+	size_t pos = 0;
+
+public:
+	explicit reader(const int fd) : fd(fd)
+	{
+		// Only read as many bytes as could be the start of a magic, so that reading a stream (e.g. a pipe) does not wait for more input than needed
+		for (;;)
+		{
+			bool partial = false;
+			for (const auto &magic : compression_magics)
+				if (prefix.size() < magic.size() and magic.substr(0, prefix.size()) == prefix)
+					partial = true;
+			if (!partial)
+				break;
+
+			char c;
+			const ssize_t n = ::read(fd, &c, 1);
+			if (n == -1 and errno == EINTR)
+				continue;
+			if (n <= 0)
+				break;
+			prefix += c;
+		}
+
+		const compression_type type = compression(prefix);
+		if (type != compression_none)
+		{
+			adecompressor = make_unique<decompressor>(fd, type, move(prefix));
+			prefix.clear();
+		}
+		block = move(prefix);
+	}
+
+	// Read up to size bytes into data, like read()
+	// Returns the number of bytes read, 0 at the end of the input or -1 on an error, which is output and sets readerror, except for EINTR.
+	ssize_t read(char *const data, const size_t size)
+	{
+		while (pos == block.size())
+		{
+			if (!adecompressor)
+			{
+				const ssize_t n = ::read(fd, data, size);
+				if (n == -1 and errno != EINTR)
+				{
+					cerr << "Error: Unable to read the input (" << strerror(errno) << ").\n";
+					readerror = true;
+				}
+				return n;
+			}
+			const int code = adecompressor->pop(block);
+			if (code == -1)
+			{
+				readerror = true;
+				errno = EIO;
+				return -1;
+			}
+			if (!code)
+				return 0;
+			pos = 0;
+		}
+
+		const size_t n = min(size, block.size() - pos);
+		memcpy(data, block.data() + pos, n);
+		pos += n;
+		return n;
+	}
+};
+
+// Stream buffer that reads from a reader, so that compressed inputs can be read line by line
+class readerbuf : public streambuf
+{
+	reader areader;
+	char buffer[1 << 16];
+
+protected:
+	int underflow() override
+	{
+		ssize_t n;
+		while ((n = areader.read(buffer, sizeof(buffer))) == -1 and errno == EINTR)
+			;
+		if (n <= 0)
+			return traits_type::eof();
+
+		setg(buffer, buffer, buffer + n);
+		return traits_type::to_int_type(*gptr());
+	}
+
+public:
+	explicit readerbuf(const int fd) : areader(fd) {}
+};
+
+// Get the end of the last whole line of the buffer, after its line delimiter, or 0 if there is none
+// With quoted fields, a line delimiter only ends a record if there is an even number of quotes before it.
+size_t lastline(const string_view &buffer, const char line_delim, const bool quoted)
+{
+	if (!quoted)
+	{
+		const size_t end = buffer.rfind(line_delim);
+		return end != string_view::npos ? end + 1 : 0;
+	}
+
+	size_t quotes = count(buffer.cbegin(), buffer.cend(), '"');
+	for (size_t i = buffer.size(); i--;)
+	{
+		if (buffer[i] == '"')
+			--quotes;
+		else if (buffer[i] == line_delim and !(quotes & 1))
+			return i + 1;
+	}
+
+	return 0;
+}
+
+// Limits on the number of rows of the input, from --head and --tail
+struct limits
+{
+	// Rows at the start that are always kept and not counted, such as a header row
+	size_t first = 0;
+	// Rows left to keep from the start, reading stops when there are none
+	size_t head = SIZE_MAX;
+	// Only the last rows are kept
+	size_t tail = SIZE_MAX;
+};
+
+// Check if a line or record is a row, since empty lines are ignored unless they are kept
+bool isrow(const string_view &line, const char line_delim, const bool quoted, const bool keep_empty_lines)
+{
+	return keep_empty_lines or !(line.empty() or (quoted and line_delim == '\n' and line == "\r"));
+}
+
+// Get the end of the next rows of a buffer of whole lines, from start, after the line delimiter of the last one
+// The number of rows is decremented for each row found, so that it can be continued with the next buffer. SIZE_MAX rows is no limit, so the buffer is not searched.
+size_t headrows(const string_view &buffer, size_t start, size_t &rows, const char line_delim, const bool quoted, const bool keep_empty_lines)
+{
+	if (rows == SIZE_MAX)
+		return buffer.size();
+
+	while (rows and start < buffer.size())
+	{
+		// With quoted fields, a line delimiter only ends a record if there is an even number of quotes before it
+		size_t end = start;
+		size_t quotes = 0;
+		for (;;)
+		{
+			const size_t next = min(buffer.find(line_delim, end), buffer.size());
+			if (quoted)
+				quotes += count(buffer.cbegin() + end, buffer.cbegin() + next, '"');
+			end = next;
+			if (!(quotes & 1) or end == buffer.size())
+				break;
+			++end;
+		}
+
+		if (isrow(buffer.substr(start, end - start), line_delim, quoted, keep_empty_lines))
+			--rows;
+		start = min(end + 1, buffer.size());
+	}
+
+	return start;
+}
+
+// Get the start of the last rows of a buffer of whole lines, searching backwards from the end, so that only the end of a mapped file is read
+// With quoted fields, the quotes of the buffer are counted first, since whether a line delimiter is inside quotes depends on all the quotes before it.
+size_t tailrows(const string_view &buffer, size_t rows, const char line_delim, const bool quoted, const bool keep_empty_lines)
+{
+	if (!rows)
+		return buffer.size();
+	if (buffer.empty())
+		return 0;
+
+	const char *const data = buffer.data();
+	size_t end = buffer.size();
+	if (data[end - 1] == line_delim)
+		--end;
+	// Number of quotes before pos
+	size_t quotes = quoted ? count(data, data + end, '"') : 0;
+
+	for (;;)
+	{
+		size_t pos = end;
+		const char *p;
+		while ((p = static_cast<const char *>(memrchr(data, line_delim, pos))))
+		{
+			if (quoted)
+				quotes -= count(p + 1, data + pos, '"');
+			pos = p - data;
+			if (!(quotes & 1))
+				break;
+		}
+
+		const size_t start = p ? pos + 1 : 0;
+		if (isrow(buffer.substr(start, end - start), line_delim, quoted, keep_empty_lines) and !--rows)
+			return start;
+		if (!p)
+			return 0;
+		end = pos;
+	}
+}
+
+// Read a file or stream (e.g. a pipe) in blocks, parsing the whole lines of each block as they are read, so that parsing overlaps with the decompression of a compressed input
+// Reading stops once there are no rows left with --head. With --tail, only the text of the last rows read so far is kept, which is parsed at the end. The rows of each block are passed to consume, and the block is then freed, so the cells are only valid until it returns.
+template <typename F>
+void input(const int fd, const char *delimiter, const char line_delim, const bool quoted, const selection &fields, const bool keep_empty_lines, const unsigned jobs, limits &alimits, const F &consume)
+{
+	// Large enough to split into chunks that are parsed at the same time
+	const size_t block = 1 << 24;
+
+	reader areader(fd);
+
+	auto parseblock = [&](const string &buffer)
+	{
+		list<string> escaped;
+		cellarray<string_view> array = input(string_view(buffer), delimiter, line_delim, quoted, fields, keep_empty_lines, jobs, escaped);
+		consume(array);
+	};
+	string rest;
+	string last;
+	const bool tail = alimits.tail != SIZE_MAX;
+
+	for (bool eof = false; !eof and (alimits.first or alimits.head);)
+	{
+		string buffer = move(rest);
+		size_t size = buffer.size();
+		buffer.resize(size + block);
+
+		while (size < buffer.size())
+		{
+			const ssize_t n = areader.read(buffer.data() + size, buffer.size() - size);
+			if (n == -1 and errno == EINTR)
+				continue;
+			// The rest of the input is not used if it could not be read, since its last row could be incomplete
+			if (n == -1)
+				return;
+			if (!n)
+			{
+				eof = true;
+				break;
+			}
+			size += n;
+		}
+		buffer.resize(size);
+
+		const size_t end = eof ? size : lastline(buffer, line_delim, quoted);
+		rest = buffer.substr(end);
+		buffer.resize(end);
+
+		const size_t first = headrows(buffer, 0, alimits.first, line_delim, quoted, keep_empty_lines);
+		size_t stop = headrows(buffer, first, alimits.head, line_delim, quoted, keep_empty_lines);
+		if (tail)
+		{
+			last.append(buffer, first, stop - first);
+			last.erase(0, tailrows(last, alimits.tail, line_delim, quoted, keep_empty_lines));
+			stop = first;
+		}
+		if (!stop)
+			continue;
+		buffer.resize(stop);
+
+		parseblock(buffer);
+	}
+
+	if (!last.empty())
+		parseblock(last);
+}
+
+// Read a file or stream (e.g. a pipe) in blocks
+// The cells of each block are interned into buffers, which the returned cells are views into.
+cellarray<string_view> input(const int fd, const char *delimiter, const char line_delim, const bool quoted, const selection &fields, const bool keep_empty_lines, const unsigned jobs, list<string> &buffers, limits &alimits)
+{
+	interner ainterner(buffers);
+	cellarray<string_view> aarray;
+
+	input(fd, delimiter, line_delim, quoted, fields, keep_empty_lines, jobs, alimits, [&](cellarray<string_view> &array)
+		  {
+		array.update([&](const size_t j, const string_view &cell)
+					 { return ainterner.intern(j, cell); });
+		aarray.append(move(array)); });
+
+	return aarray;
+}
+
+// Parse a whole input, such as a mapped file, with the --head and --tail limits
+// Only the rows that are kept are parsed: the rows that are always kept, then the last rows of those left with --head.
+cellarray<string_view> input(const string_view &buffer, const char *delimiter, const char line_delim, const bool quoted, const selection &fields, const bool keep_empty_lines, const unsigned jobs, list<string> &escaped, limits &alimits)
+{
+	const size_t first = headrows(buffer, 0, alimits.first, line_delim, quoted, keep_empty_lines);
+	const size_t end = headrows(buffer, first, alimits.head, line_delim, quoted, keep_empty_lines);
+	const string_view rest = buffer.substr(first, end - first);
+	const size_t start = alimits.tail != SIZE_MAX ? tailrows(rest, alimits.tail, line_delim, quoted, keep_empty_lines) : 0;
+
+	cellarray<string_view> aarray = input(buffer.substr(0, first), delimiter, line_delim, quoted, fields, keep_empty_lines, jobs, escaped);
+	aarray.append(input(rest.substr(start), delimiter, line_delim, quoted, fields, keep_empty_lines, jobs, escaped));
+
+	return aarray;
+}
+
+// Map the rest of a regular file into memory, from the current file offset
+// Returns false if the file is not a regular file (e.g. a pipe) or it is compressed, which must then be read as a stream instead. The mapping is never unmapped, since the cells are views into it until the program exits.
+bool mapfile(const int fd, string_view &buffer)
+{
+	struct stat st;
+	if (fstat(fd, &st) == -1 or !S_ISREG(st.st_mode))
+		return false;
+
+	const off_t offset = lseek(fd, 0, SEEK_CUR);
+	if (offset == -1)
+		return false;
+
+	buffer = {};
+	if (offset >= st.st_size)
+		return true;
+
+	void *const addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (addr == MAP_FAILED)
+		return false;
+
+	buffer = {static_cast<const char *>(addr) + offset, static_cast<size_t>(st.st_size - offset)};
+
+	if (compression(buffer) != compression_none)
+	{
+		munmap(addr, st.st_size);
+		return false;
+	}
+
+	// Consume the file, as if it had been read
+	lseek(fd, 0, SEEK_END);
+
+	return true;
+}
+
+// Check if [first, last) only has printable ASCII characters, which are each one terminal column wide, so that the display width is the length
+bool printable_scalar(const char *first, const char *last)
+{
+	for (; first < last; ++first)
+		if (*first < ' ' or *first > '~')
+			return false;
+
+	return true;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2"))) bool printable_sse2(const char *first, const char *last)
+{
+	// The bytes are signed, so the non-ASCII bytes are less than the space
+	const __m128i low = _mm_set1_epi8(' ' - 1);
+	const __m128i high = _mm_set1_epi8('~' + 1);
+
+	for (; last - first >= 16; first += 16)
+	{
+		const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+		const __m128i match = _mm_and_si128(_mm_cmpgt_epi8(block, low), _mm_cmplt_epi8(block, high));
+		if (_mm_movemask_epi8(match) != 0xFFFF)
+			return false;
+	}
+
+	return printable_scalar(first, last);
+}
+
+__attribute__((target("avx2"))) bool printable_avx2(const char *first, const char *last)
+{
+	const __m256i low = _mm256_set1_epi8(' ' - 1);
+	const __m256i high = _mm256_set1_epi8('~' + 1);
+
+	for (; last - first >= 32; first += 32)
+	{
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+		const __m256i match = _mm256_and_si256(_mm256_cmpgt_epi8(block, low), _mm256_cmpgt_epi8(high, block));
+		if (static_cast<unsigned>(_mm256_movemask_epi8(match)) != 0xFFFFFFFF)
+			return false;
+	}
+
+	return printable_sse2(first, last);
+}
+#endif
+
+bool printable(const string_view &str)
+{
+	using printable_type = bool (*)(const char *, const char *);
+
+	static const printable_type best = []
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+			return printable_avx2;
+		if (__builtin_cpu_supports("sse2"))
+			return printable_sse2;
+#endif
+		return printable_scalar;
+	}();
+
+	return best(str.data(), str.data() + str.size());
+}
+
+// Get the length of the longest prefix of str that fits in width terminal columns and its display width (awidth), skipping ANSI escape sequences
+// At least one character is always included, so that wrapping makes progress.
+size_t fit(const string_view &str, const size_t width, size_t &awidth)
+{
+	if (printable(str))
+	{
+		awidth = str.empty() ? 0 : std::max(min(str.size(), width), size_t(1));
+		return awidth;
+	}
+
+	mbstate_t state{};
+	awidth = 0;
+	bool empty = true;
+
+	size_t i = 0;
+	while (i < str.size())
+	{
+		if (str[i] == '\e')
+		{
+			++i;
+			if (i < str.size() and str[i] == '[')
+			{
+				++i;
+				while (i < str.size() and (str[i] < '@' or str[i] > '~'))
+					++i;
+				if (i < str.size())
+					++i;
+			}
+			continue;
+		}
+
+		wchar_t wc;
+		size_t len = mbrtowc(&wc, str.data() + i, str.size() - i, &state);
+		int w = 1;
+		if (len == static_cast<size_t>(-1) or len == static_cast<size_t>(-2))
+		{
+			state = {};
+			len = 1;
+		}
+		else
+		{
+			if (!len)
+				len = 1;
+			w = max(wcwidth(wc), 0);
+		}
+
+		if (awidth + w > width and !empty)
+			break;
+
+		awidth += w;
+		i += len;
+		empty = false;
+	}
+
+	return i;
+}
+
+// Output a border of a streamed table: 0 top, 1 middle or 2 bottom
+size_t outputborder(const vector<size_t> &columnwidth, const unsigned line, const tables::options &aoptions)
+{
+	const char *const *const style = tables::styles[aoptions.style];
+	const bool separators = aoptions.tableborder or aoptions.cellborder or aoptions.headerrow or aoptions.headercolumn;
+
+	if (aoptions.tableborder)
+		cout << style[2 + (line * 3)];
+
+	for (size_t j = 0; j < columnwidth.size(); ++j)
+	{
+		if (j)
+		{
+			if (aoptions.cellborder or (j == 1 and aoptions.headercolumn))
+				cout << style[3 + (line * 3)];
+			else if (separators)
+				cout << style[0];
+		}
+
+		for (size_t k = 0; k < columnwidth[j] + (2 * aoptions.padding); ++k)
+			cout << style[0];
+	}
+
+	if (aoptions.tableborder)
+		cout << style[4 + (line * 3)];
+	cout << '\n';
+
+	return 1;
+}
+
+// Output a row of a streamed table, truncating or wrapping the cells that do not fit in their column
+// Returns the number of lines output.
+size_t outputrow(vector<string_view> array, const vector<size_t> &columnwidth, const bool headerrow, const bool wrap, const tables::options &aoptions)
+{
+	const char *const *const style = tables::styles[aoptions.style];
+	const bool separators = aoptions.tableborder or aoptions.cellborder or aoptions.headerrow or aoptions.headercolumn;
+	const size_t columns = columnwidth.size();
+
+	array.resize(columns);
+
+	size_t lines = 0;
+	bool more = true;
+	while (more)
+	{
+		more = false;
+
+		if (aoptions.tableborder)
+			cout << style[1];
+
+		for (size_t j = 0; j < columns; ++j)
+		{
+			if (j)
+			{
+				if (aoptions.cellborder or (j == 1 and aoptions.headercolumn))
+					cout << style[1];
+				else if (separators)
+					cout << ' ';
+			}
+
+			size_t width;
+			const size_t len = fit(array[j], columnwidth[j], width);
+			const string_view cell = array[j].substr(0, len);
+			const bool cut = len < array[j].size();
+			const size_t difference = columnwidth[j] > width ? columnwidth[j] - width : 0;
+
+			cout << string(aoptions.padding, ' ');
+			if (headerrow or (j == 0 and aoptions.headercolumn))
+				cout << string(difference / 2, ' ') << "\e[1m" << cell << "\e[22m" << string(difference - (difference / 2), ' ');
+			else if (aoptions.alignment == ios_base::right)
+				cout << string(difference, ' ') << cell;
+			else
+				cout << cell << string(difference, ' ');
+			if (cut and cell.find('\e') != string_view::npos)
+				cout << "\e[m";
+			cout << string(aoptions.padding, ' ');
+
+			array[j] = wrap ? array[j].substr(len) : string_view();
+			if (!array[j].empty())
+				more = true;
+		}
+
+		if (aoptions.tableborder)
+			cout << style[1];
+		cout << '\n';
+		++lines;
+	}
+
+	return lines;
+}
+
+// Output the rows of array as a table, with as many rows on each line as fit in width terminal columns
+template <typename T>
+int column(const size_t width, const T &array, const tables::options &aoptions)
+{
+	const size_t rows = array.size();
+	const size_t columns = array[0].size();
+	const size_t total = rows * columns;
+
+	// Display width of each cell, in row-major order
+	vector<size_t> cellwidth(total);
+
+	for (size_t i = 0; i < rows; ++i)
+	{
+		for (size_t j = 0; j < columns; ++j)
+		{
+			// The width of the cell above is reused when it is the same interned value
+			const auto &cell = array[i][j];
+			if (i and cell.data() == array[i - 1][j].data() and cell.size() == array[i - 1][j].size())
+				cellwidth[(i * columns) + j] = cellwidth[((i - 1) * columns) + j];
+			else
+				fit(cell, SIZE_MAX, cellwidth[(i * columns) + j]);
+		}
+	}
+
+	const bool border = aoptions.tableborder or aoptions.cellborder or aoptions.headerrow or aoptions.headercolumn;
+
+	// Width of the padding and borders of a table with acolumns columns
+	auto padding = [&](const size_t acolumns)
+	{
+		return border ? (((2 * aoptions.padding) + 1) * acolumns) + (aoptions.tableborder ? 1 : -1) : (2 * aoptions.padding) * acolumns;
+	};
+
+	// The first line has the first rows, so their total width is a lower bound that only increases with the number of rows on each line
+	vector<size_t> prefix(rows + 1);
+
+	for (size_t i = 0; i < rows; ++i)
+		prefix[i + 1] = prefix[i] + accumulate(cellwidth.cbegin() + (i * columns), cellwidth.cbegin() + ((i + 1) * columns), size_t(0));
+
+	size_t low = 1;
+	size_t high = rows;
+
+	while (low < high)
+	{
+		const size_t mid = low + ((high - low + 1) / 2);
+
+		if (prefix[mid] + padding(mid * columns) <= width)
+			low = mid;
+		else
+			high = mid - 1;
+	}
+
+	// The actual width does not always increase with the number of rows on each line, so each is checked from that bound down until one fits, stopping each check as soon as it is too wide
+	vector<size_t> columnwidth;
+	size_t acolumns = low * columns;
+
+	for (; acolumns > columns; acolumns -= columns)
+	{
+		columnwidth.assign(acolumns, 0);
+
+		size_t awidth = padding(acolumns);
+		bool fits = true;
+
+		for (size_t i = 0; i < total and fits; ++i)
+		{
+			size_t &acolumnwidth = columnwidth[i % acolumns];
+
+			if (cellwidth[i] > acolumnwidth)
+			{
+				awidth += cellwidth[i] - acolumnwidth;
+				acolumnwidth = cellwidth[i];
+				fits = awidth <= width;
+			}
+		}
+
+		if (fits)
+			break;
+	}
+
+	const size_t arows = (total + acolumns - 1) / acolumns;
+
+	vector<vector<typename T::value_type::value_type>> aarray(arows);
+
+	for (size_t i = 0; i < rows; ++i)
+	{
+		const size_t k = (i * columns) / acolumns;
+
+		aarray[k].insert(aarray[k].end(), array[i].cbegin(), array[i].cend());
+	}
+
+	if (total % acolumns)
+		aarray.back().resize(acolumns);
+
+	string *headerrow = nullptr;
+	string *headercolumn = nullptr;
+
+	return tables::array(aarray, headerrow, headercolumn, aoptions);
+}
+
+// Summary of a stream of numbers: count, minimum, maximum, mean, standard deviation and quantiles
+// The quantiles are estimated with a t-digest, which keeps the numbers in at most about compression * log(count) weighted centroids, with the smallest near the minimum and maximum, so it uses bounded memory. Summaries can be merged, so that parts of the input can be summarized on separate threads.
+class summary
+{
+	static constexpr long double compression = 200;
+	static constexpr size_t buffer_size = 4096;
 
-	for (size_t i = 0; i < argsize; ++i)
-		if (!strncmp(arglist[i], arg, arglen) and strlen(arglist[i]) == arglen)
-			return vallist[i];
+	// Mean and count of each centroid, sorted by mean
+	vector<pair<long double, long double>> centroids;
+	// Numbers and centroids that have not been merged into the centroids yet
+	vector<pair<long double, long double>> buffer;
 
-	cerr << "Error: Invalid argument " << quoted(arg) << " for " << quoted(context) << '\n';
-	exit(1);
+	void compress()
+	{
+		if (buffer.empty())
+			return;
 
-	// return -1;
+		buffer.insert(buffer.end(), centroids.cbegin(), centroids.cend());
+		sort(buffer.begin(), buffer.end());
+		centroids.clear();
+
+		long double total = 0;
+		for (const auto &centroid : buffer)
+			total += centroid.second;
+
+		// Merge adjacent centroids while their combined count is within the size limit of their quantile
+		long double sofar = 0;
+		auto current = buffer.front();
+		for (size_t i = 1; i < buffer.size(); ++i)
+		{
+			const long double proposed = current.second + buffer[i].second;
+			const long double q0 = sofar / total;
+			const long double q2 = (sofar + proposed) / total;
+
+			if (proposed <= total * std::min(q0 * (1 - q0), q2 * (1 - q2)) * 4 / compression)
+			{
+				current.first += (buffer[i].first - current.first) * buffer[i].second / proposed;
+				current.second = proposed;
+			}
+			else
+			{
+				sofar += current.second;
+				centroids.push_back(current);
+				current = buffer[i];
+			}
+		}
+		centroids.push_back(current);
+
+		buffer.clear();
+	}
+
+public:
+	size_t count = 0;
+	long double min = numeric_limits<long double>::infinity();
+	long double max = -numeric_limits<long double>::infinity();
+	long double mean = 0;
+	// Sum of the squared differences from the mean
+	long double m2 = 0;
+
+	void add(const long double x)
+	{
+		// NaN is not a number, and would break the ordering of the buffer
+		if (isnan(x))
+			return;
+
+		++count;
+		min = std::min(min, x);
+		max = std::max(max, x);
+
+		const long double delta = x - mean;
+		mean += delta / count;
+		m2 += delta * (x - mean);
+
+		buffer.emplace_back(x, 1);
+		if (buffer.size() >= buffer_size)
+			compress();
+	}
+
+	void merge(const summary &other)
+	{
+		if (!other.count)
+			return;
+
+		const size_t n = count + other.count;
+		const long double delta = other.mean - mean;
+		mean += delta * other.count / n;
+		m2 += other.m2 + delta * delta * count * other.count / n;
+		count = n;
+		min = std::min(min, other.min);
+		max = std::max(max, other.max);
+
+		buffer.insert(buffer.end(), other.centroids.cbegin(), other.centroids.cend());
+		buffer.insert(buffer.end(), other.buffer.cbegin(), other.buffer.cend());
+		compress();
+	}
+
+	long double stddev() const { return count > 1 ? sqrt(m2 / (count - 1)) : 0; }
+
+	// Interpolates between the means of the centroids, which each represent the numbers around the middle of their count
+	long double quantile(const long double q)
+	{
+		compress();
+
+		if (centroids.empty())
+			return numeric_limits<long double>::quiet_NaN();
+
+		const long double rank = q * count;
+
+		long double sofar = 0;
+		long double previous = min;
+		long double center = 0;
+		for (const auto &[amean, acount] : centroids)
+		{
+			const long double acenter = sofar + (acount / 2);
+			if (rank < acenter)
+				return previous + (amean - previous) * (center < acenter ? (rank - center) / (acenter - center) : 0);
+
+			sofar += acount;
+			previous = amean;
+			center = acenter;
+		}
+
+		return previous + (max - previous) * (count > center ? (rank - center) / (count - center) : 0);
+	}
+};
+
+enum sort_type
+{
+	sort_lexical,
+	sort_numeric,
+	sort_human,
+	sort_version
+};
+
+// Key to sort the rows by: a column, numbered from 0, and how its cells are compared
+struct sortkey
+{
+	size_t column;
+	sort_type type;
+	bool reverse;
+};
+
+// Get the sort keys from a list of columns, numbered from 1, each followed by the letters of its type, like sort -k (e.g. 3n,1 or 5hr)
+// n is numeric, h is human readable sizes (e.g. 2K or 1.5G), V is version numbers (e.g. 1.10 after 1.9) and r reverses the order. Returns false if it is not valid.
+bool parsekeys(const string &list, vector<sortkey> &keys)
+{
+	keys.clear();
+
+	const vector<string> tokens = split(list);
+	if (tokens.empty())
+		return false;
+
+	for (const auto &token : tokens)
+	{
+		const char *p = token.c_str();
+		char *q;
+		errno = 0;
+
+		if (!isdigit(*p))
+			return false;
+
+		const size_t column = strtoul(p, &q, 10);
+		if (!column or errno == ERANGE)
+			return false;
+
+		sortkey akey = {column - 1, sort_lexical, false};
+		for (p = q; *p; ++p)
+		{
+			if (*p == 'r' and !akey.reverse)
+				akey.reverse = true;
+			else if (*p == 'n' and akey.type == sort_lexical)
+				akey.type = sort_numeric;
+			else if (*p == 'h' and akey.type == sort_lexical)
+				akey.type = sort_human;
+			else if (*p == 'V' and akey.type == sort_lexical)
+				akey.type = sort_version;
+			else
+				return false;
+		}
+
+		keys.push_back(akey);
+	}
+
+	return true;
 }
 
-template <typename T>
-vector<basic_string<T>> split(const basic_string<T> &s, const T delim = ',')
+// Get the number at the start of a cell like sort -n: blanks, an optional minus sign, then digits with an optional decimal point, multiplied by its binary suffix if human (e.g. 2K is 2048)
+// Cells that do not start with a number are 0, as are exponents, hexadecimal numbers, infinity and NaN, which sort -n does not accept.
+long double sortnumber(const string_view &cell, const bool human, string &temp)
 {
-	basic_istringstream<T> ss(s);
-	basic_string<T> item;
-	vector<basic_string<T>> result;
+	size_t i = 0;
+	while (i < cell.size() and (cell[i] == ' ' or cell[i] == '\t'))
+		++i;
 
-	while (getline(ss, item, delim))
+	const size_t start = i;
+	if (i < cell.size() and cell[i] == '-')
+		++i;
+
+	bool digits = false;
+	for (bool point = false; i < cell.size(); ++i)
 	{
-		result.push_back(item);
+		if (isdigit(static_cast<unsigned char>(cell[i])))
+			digits = true;
+		else if (cell[i] == '.' and !point)
+			point = true;
+		else
+			break;
 	}
 
-	return result;
+	if (!digits)
+		return 0;
+
+	temp = cell.substr(start, i - start);
+	long double number = strtold(temp.c_str(), nullptr);
+
+	if (human and i < cell.size())
+	{
+		const string_view suffixes = "KMGTPEZY";
+		const size_t suffix = suffixes.find(cell[i] == 'k' ? 'K' : cell[i]);
+		if (suffix != string_view::npos)
+			for (size_t j = 0; j <= suffix; ++j)
+				number *= 1024;
+	}
+
+	return number;
 }
 
-template <typename T>
-vector<vector<basic_string<T>>> input(basic_istream<T> &in, const char *delimiter, const char line_delim, const bool keep_empty_lines)
+// Compare two cells as version numbers, with each run of digits compared as a number and the other characters compared as bytes
+int versioncompare(const string_view &a, const string_view &b)
+{
+	size_t i = 0;
+	size_t j = 0;
+
+	while (i < a.size() and j < b.size())
+	{
+		if (isdigit(static_cast<unsigned char>(a[i])) and isdigit(static_cast<unsigned char>(b[j])))
+		{
+			while (i < a.size() and a[i] == '0')
+				++i;
+			while (j < b.size() and b[j] == '0')
+				++j;
+
+			const size_t istart = i;
+			const size_t jstart = j;
+			while (i < a.size() and isdigit(static_cast<unsigned char>(a[i])))
+				++i;
+			while (j < b.size() and isdigit(static_cast<unsigned char>(b[j])))
+				++j;
+
+			// The number with more digits is larger, otherwise they are compared digit by digit
+			if (i - istart != j - jstart)
+				return i - istart < j - jstart ? -1 : 1;
+			if (const int c = a.substr(istart, i - istart).compare(b.substr(jstart, j - jstart)))
+				return c;
+		}
+		else
+		{
+			if (a[i] != b[j])
+				return static_cast<unsigned char>(a[i]) < static_cast<unsigned char>(b[j]) ? -1 : 1;
+			++i;
+			++j;
+		}
+	}
+
+	return (i < a.size()) - (j < b.size());
+}
+
+// Sort the values with the stable comparison less, sorting a part on each thread, then merging pairs of the sorted parts on separate threads until there is one
+template <typename T, typename F>
+void parallel_sort(vector<T> &values, const unsigned jobs, const F &less)
+{
+	// At least 64 Ki values in each part
+	const size_t parts = min(static_cast<size_t>(jobs), max(values.size() >> 16, size_t(1)));
+
+	vector<size_t> bounds(parts + 1);
+	for (size_t i = 0; i <= parts; ++i)
+		bounds[i] = values.size() * i / parts;
+
+	parallel(parts, jobs, [&](const size_t i)
+			 { stable_sort(values.begin() + bounds[i], values.begin() + bounds[i + 1], less); });
+
+	if (parts == 1)
+		return;
+
+	vector<T> temp(values.size());
+
+	for (size_t width = 1; width < parts; width *= 2)
+	{
+		parallel((parts + (2 * width) - 1) / (2 * width), jobs, [&](const size_t i)
+				 {
+			const size_t first = bounds[2 * i * width];
+			const size_t middle = bounds[min((2 * i + 1) * width, parts)];
+			const size_t last = bounds[min((2 * i + 2) * width, parts)];
+			merge(values.cbegin() + first, values.cbegin() + middle, values.cbegin() + middle, values.cbegin() + last, temp.begin() + first, less); });
+
+		values.swap(temp);
+	}
+}
+
+// Sort the rows from first on by the keys, then by their order in the input
+// The cells of each key are parsed once, on separate threads, into a column of numbers or strings, which are then compared instead of the cells. Returns the order of the rows for cellarray::reorder().
+vector<size_t> sortrows(const cellarray<string_view> &aarray, const size_t first, const vector<sortkey> &keys, const unsigned jobs)
+{
+	const size_t rows = aarray.size() - first;
+
+	// Sort key of each row, which is a number with the numeric and human types
+	struct keycolumn
+	{
+		vector<long double> numbers;
+		vector<string_view> strings;
+	};
+
+	vector<keycolumn> columns(keys.size());
+	for (size_t k = 0; k < keys.size(); ++k)
+	{
+		if (keys[k].type == sort_numeric or keys[k].type == sort_human)
+			columns[k].numbers.resize(rows);
+		else
+			columns[k].strings.resize(rows);
+	}
+
+	const size_t block = 1 << 16;
+
+	parallel((rows + block - 1) / block, jobs, [&](const size_t i)
+			 {
+		string temp;
+		for (size_t j = i * block; j < min((i + 1) * block, rows); ++j)
+		{
+			const auto &array = aarray[first + j];
+			for (size_t k = 0; k < keys.size(); ++k)
+			{
+				const sortkey &akey = keys[k];
+				const string_view cell = akey.column < array.size() ? array[akey.column] : string_view();
+				if (akey.type == sort_numeric or akey.type == sort_human)
+					columns[k].numbers[j] = sortnumber(cell, akey.type == sort_human, temp);
+				else
+					columns[k].strings[j] = cell;
+			}
+		} });
+
+	vector<size_t> order(rows);
+	iota(order.begin(), order.end(), 0);
+
+	// The rows are stably sorted by each key, from the last to the first, so that the rows with the same first key are in the order of the other keys
+	// Each key is sorted together with the index of its row, so that it is compared without an indirection.
+	auto sort = [&](const sortkey &akey, auto &column)
+	{
+		using T = typename decay_t<decltype(column)>::value_type;
+
+		vector<pair<T, size_t>> entries(rows);
+		for (size_t j = 0; j < rows; ++j)
+			entries[j] = {column[order[j]], order[j]};
+		column = {};
+
+		parallel_sort(entries, jobs, [&](const pair<T, size_t> &a, const pair<T, size_t> &b)
+					  {
+			int c;
+			if constexpr (is_same_v<T, long double>)
+				c = (a.first > b.first) - (a.first < b.first);
+			else if (akey.type == sort_version)
+				c = versioncompare(a.first, b.first);
+			else
+				c = a.first.compare(b.first);
+			return akey.reverse ? c > 0 : c < 0; });
+
+		for (size_t j = 0; j < rows; ++j)
+			order[j] = entries[j].second;
+	};
+
+	for (size_t k = keys.size(); k--;)
+	{
+		if (columns[k].strings.empty())
+			sort(keys[k], columns[k].numbers);
+		else
+			sort(keys[k], columns[k].strings);
+	}
+
+	return order;
+}
+
+// Get the columns from a list of columns, numbered from 1 (e.g. 2,1), returns false if it is not valid
+bool parsecolumns(const string &list, vector<size_t> &columns)
+{
+	columns.clear();
+
+	const vector<string> tokens = split(list);
+	if (tokens.empty())
+		return false;
+
+	for (const auto &token : tokens)
+	{
+		char *p;
+		errno = 0;
+		const size_t column = strtoul(token.c_str(), &p, 10);
+		if (!isdigit(token[0]) or *p or !column or errno == ERANGE)
+			return false;
+
+		columns.push_back(column - 1);
+	}
+
+	return true;
+}
+
+enum aggregate_type
+{
+	aggregate_count,
+	aggregate_sum,
+	aggregate_min,
+	aggregate_max,
+	aggregate_mean,
+	aggregate_quantile
+};
+
+// Aggregate of each group: a function of the numbers of a column, numbered from 0
+struct aggregate
+{
+	aggregate_type type;
+	// SIZE_MAX for the number of rows with count
+	size_t column;
+	// Quantile of the pN functions (e.g. 0.99 for p99)
+	long double q;
+	string name;
+};
+
+// Get the aggregates from a list of functions, each followed by a colon and a column, numbered from 1 (e.g. sum:5,count,max:4,p99:4)
+// The functions are count, sum, min, max, mean and pN for the Nth percentile (e.g. p50 or p99.9). count counts the rows of each group, or the cells that are numbers with a column. Returns false if it is not valid.
+bool parseaggregates(const string &list, vector<aggregate> &aggregates)
+{
+	aggregates.clear();
+
+	const vector<string> tokens = split(list);
+	if (tokens.empty())
+		return false;
+
+	for (const auto &token : tokens)
+	{
+		const size_t pos = token.find(':');
+		aggregate aaggregate = {aggregate_count, SIZE_MAX, 0, token.substr(0, pos)};
+		const string &name = aaggregate.name;
+
+		if (name == "count")
+			aaggregate.type = aggregate_count;
+		else if (name == "sum")
+			aaggregate.type = aggregate_sum;
+		else if (name == "min")
+			aaggregate.type = aggregate_min;
+		else if (name == "max")
+			aaggregate.type = aggregate_max;
+		else if (name == "mean")
+			aaggregate.type = aggregate_mean;
+		else if (name.size() > 1 and name[0] == 'p' and isdigit(name[1]))
+		{
+			char *p;
+			aaggregate.type = aggregate_quantile;
+			aaggregate.q = strtold(name.c_str() + 1, &p) / 100;
+			if (*p or aaggregate.q > 1)
+				return false;
+		}
+		else
+			return false;
+
+		if (pos != string::npos)
+		{
+			char *p;
+			errno = 0;
+			const char *const column = token.c_str() + pos + 1;
+			aaggregate.column = strtoul(column, &p, 10);
+			if (!isdigit(*column) or *p or !aaggregate.column or errno == ERANGE)
+				return false;
+			--aaggregate.column;
+		}
+		else if (aaggregate.type != aggregate_count)
+			return false;
+
+		aggregates.push_back(aaggregate);
+	}
+
+	return true;
+}
+
+// Accumulated numbers of an aggregate of a group, with a summary only for the quantiles
+struct accumulator
+{
+	size_t count = 0;
+	long double sum = 0;
+	long double min = numeric_limits<long double>::infinity();
+	long double max = -numeric_limits<long double>::infinity();
+	summary asummary;
+
+	void add(const long double x, const bool quantile)
+	{
+		if (isnan(x))
+			return;
+
+		++count;
+		sum += x;
+		min = std::min(min, x);
+		max = std::max(max, x);
+		if (quantile)
+			asummary.add(x);
+	}
+
+	void merge(const accumulator &other)
+	{
+		count += other.count;
+		sum += other.sum;
+		min = std::min(min, other.min);
+		max = std::max(max, other.max);
+		asummary.merge(other.asummary);
+	}
+};
+
+// Groups of rows by their cells of the columns, with the aggregates of each group
+// The rows that are added are split into parts of a fixed size, which each have their own hash table of the groups and are grouped on separate threads, jobs at a time. Their groups are then merged in order, so that they are in the order that they first appear in the input and the aggregates (e.g. the estimated percentiles) do not depend on the number of threads. The cells of the columns of each new group are copied, so that the rows can be freed once they are added.
+class grouper
 {
-	vector<vector<basic_string<T>>> aarray;
+	template <typename T>
+	struct group
+	{
+		vector<T> cells;
+		size_t rows = 0;
+		vector<accumulator> accumulators;
+	};
+
+	template <typename T>
+	struct part
+	{
+		// Index of each group from its key
+		unordered_map<string, size_t> index;
+		vector<group<T>> groups;
+	};
+
+	const vector<size_t> &columns;
+	const vector<aggregate> &aggregates;
+	const unsigned jobs;
+	part<string> apart;
+
+	// The key of a group has the size of each cell before it, so that different cells never have the same key
+	template <typename T>
+	static void key(const vector<T> &cells, string &akey)
+	{
+		akey.clear();
+		for (const auto &cell : cells)
+		{
+			const size_t size = cell.size();
+			akey.append(reinterpret_cast<const char *>(&size), sizeof(size));
+			akey.append(cell);
+		}
+	}
+
+	// Group the rows from start to end into a part
+	void grouprows(const cellarray<string_view> &aarray, const size_t start, const size_t end, part<string_view> &apart) const
+	{
+		vector<string_view> cells(columns.size());
+		string akey;
+		string temp;
+
+		for (size_t k = start; k < end; ++k)
+		{
+			const auto &array = aarray[k];
+			for (size_t j = 0; j < columns.size(); ++j)
+				cells[j] = columns[j] < array.size() ? array[columns[j]] : string_view();
+			key(cells, akey);
+
+			const auto [iter, inserted] = apart.index.try_emplace(akey, apart.groups.size());
+			if (inserted)
+				apart.groups.push_back({cells, 0, vector<accumulator>(aggregates.size())});
+
+			group<string_view> &agroup = apart.groups[iter->second];
+			++agroup.rows;
+
+			for (size_t j = 0; j < aggregates.size(); ++j)
+			{
+				const aggregate &aaggregate = aggregates[j];
+				if (aaggregate.column >= array.size() or array[aaggregate.column].empty())
+					continue;
+
+				// Only cells that are entirely a number are included
+				temp = array[aaggregate.column];
+				char *p;
+				const long double number = strtold(temp.c_str(), &p);
+				if (!*p)
+					agroup.accumulators[j].add(number, aaggregate.type == aggregate_quantile);
+			}
+		}
+	}
+
+public:
+	grouper(const vector<size_t> &columns, const vector<aggregate> &aggregates, const unsigned jobs) : columns(columns), aggregates(aggregates), jobs(jobs) {}
 
-	basic_string<T> line;
-	while (getline(in, line, line_delim))
+	// Group the rows from first on
+	void add(const cellarray<string_view> &aarray, const size_t first)
 	{
-		if (!line.empty())
+		const size_t rows = aarray.size() - first;
+		const size_t block = 1 << 16;
+		const size_t blocks = (rows + block - 1) / block;
+
+		string akey;
+		for (size_t start = 0; start < blocks; start += jobs)
 		{
-			vector<basic_string<T>> array;
+			vector<part<string_view>> parts(min(static_cast<size_t>(jobs), blocks - start));
+
+			parallel(parts.size(), jobs, [&](const size_t i)
+					 { grouprows(aarray, first + ((start + i) * block), first + min((start + i + 1) * block, rows), parts[i]); });
 
-			if (delimiter)
+			for (auto &temp : parts)
 			{
-				size_t pos = 0;
-				do
+				for (auto &agroup : temp.groups)
 				{
-					const size_t end = line.find_first_of(delimiter, pos);
-					array.push_back(line.substr(pos, end - pos));
-					pos = end != basic_string<T>::npos ? end + 1 : end;
-				} while (pos != basic_string<T>::npos);
+					key(agroup.cells, akey);
+					const auto [iter, inserted] = apart.index.try_emplace(akey, apart.groups.size());
+					if (inserted)
+					{
+						apart.groups.push_back({vector<string>(agroup.cells.cbegin(), agroup.cells.cend()), agroup.rows, move(agroup.accumulators)});
+						continue;
+					}
+
+					group<string> &other = apart.groups[iter->second];
+					other.rows += agroup.rows;
+					for (size_t j = 0; j < aggregates.size(); ++j)
+						other.accumulators[j].merge(agroup.accumulators[j]);
+				}
+				temp = {};
 			}
-			else
+		}
+	}
+
+	// Returns a row for each group with its cells of the columns, then its aggregates
+	vector<vector<string>> groups()
+	{
+		vector<vector<string>> agroups;
+		agroups.reserve(apart.groups.size());
+
+		for (auto &agroup : apart.groups)
+		{
+			vector<string> row(agroup.cells.cbegin(), agroup.cells.cend());
+
+			for (size_t j = 0; j < aggregates.size(); ++j)
 			{
-				basic_istringstream<T> ss(line);
-				basic_string<T> token;
-				while (ss >> token)
+				const aggregate &aaggregate = aggregates[j];
+				accumulator &aaccumulator = agroup.accumulators[j];
+
+				if (aaggregate.type == aggregate_count)
+				{
+					row.push_back(to_string(aaggregate.column == SIZE_MAX ? agroup.rows : aaccumulator.count));
+					continue;
+				}
+
+				// The groups without any numbers have an empty cell
+				if (!aaccumulator.count)
+				{
+					row.emplace_back();
+					continue;
+				}
+
+				long double value = 0;
+				switch (aaggregate.type)
 				{
-					array.push_back(token);
+				case aggregate_sum:
+					value = aaccumulator.sum;
+					break;
+				case aggregate_min:
+					value = aaccumulator.min;
+					break;
+				case aggregate_max:
+					value = aaccumulator.max;
+					break;
+				case aggregate_mean:
+					value = aaccumulator.sum / aaccumulator.count;
+					break;
+				default:
+					value = aaccumulator.asummary.quantile(aaggregate.q);
 				}
+
+				// Enough digits that sums of integers below 10^18 are exact
+				ostringstream strm;
+				strm << setprecision(numeric_limits<long double>::digits10) << value;
+				row.push_back(strm.str());
 			}
 
-			aarray.push_back(array);
+			agroups.push_back(move(row));
 		}
-		else if (keep_empty_lines)
-			aarray.push_back({});
-	}
 
-	return aarray;
-}
+		return agroups;
+	}
+};
 
 // Output usage
 void usage(const char *const programname)
@@ -100,7 +3131,7 @@ void usage(const char *const programname)
 	cerr << "Usage:  " << programname << R"( [OPTION(S)]... [FILE(S)]...
 or:     )"
 		 << programname << R"d( <OPTION>
-Convert input into a table. With no FILE, or when FILE is -, read from standard input. Empty lines are ignored. All rows should have the same number of columns. Table cells can contain Unicode characters and formatted text with ANSI escape sequences. See examples below.
+Convert input into a table. With no FILE, or when FILE is -, read from standard input. Input compressed with gzip, zstd or xz is decompressed automatically. Empty lines are ignored. All rows should have the same number of columns. Table cells can contain Unicode characters and formatted text with ANSI escape sequences. See examples below.
 
 Options:
     Mandatory arguments to long options are mandatory for short options too.
@@ -121,8 +3152,42 @@ Options:
     -L, --keep-empty-lines  Do not ignore empty lines
     -s, --separator <SEP>   Characters to delimit columns/fields (default any whitespace)
     -d, --delimiter <SEP>   
+        --csv               Comma separated values (CSV)
+                                Fields can be quoted with double quotes ("), so that they can contain the separators, line delimiters and escaped double quotes (""), as in RFC 4180. Lines can end with a carriage return. Use --separator to change the separator.
+        --tsv               Tab separated values (TSV)
+                                Same as --csv, but the default separator is a tab.
+        --fields <LIST>     Fields to use
+                                Only use the selected fields (columns) of each line, the others are skipped without being stored. Provide a comma separated list of fields and ranges of fields, numbered from 1, as in cut -f (e.g. 1,3,7-9 or 5-). The fields are used in the order of the input.
+        --head <ROWS>       Only use the first ROWS rows
+                                Reading stops once they have been read. With --header-row, the header row is always kept and not counted. With multiple inputs, the rows of all the inputs are counted.
+        --tail <ROWS>       Only use the last ROWS rows
+                                Only the last rows are kept while reading and regular files are searched backwards from the end. Otherwise the same as --head. With both, the last rows of the first rows are used.
+        --sort <KEYS>       Sort the rows
+                                Provide a comma separated list of columns to sort by, numbered from 1, each followed by the letters of its type, as in sort -k (e.g. 3n,1). The types are: n numeric, as in sort -n, where cells that do not start with a number are 0, h the same with a binary suffix (e.g. 2K is 2048) and V version numbers. Cells are compared as bytes by default. Add r to reverse the order. Rows with equal keys keep their order. The header row stays first with --header-row. Not supported with --stream.
     -z, --zero-terminated   Line delimiter is NUL, not newline
+    -j, --jobs <JOBS>       Number of threads (default 0)
+                                Split large inputs into up to JOBS chunks, which are parsed at the same time. If JOBS is 0, it will be set to the number of processor cores.
     -p, --padding <PADDING> Cell padding (default 1)
+        --stream <ROWS>     Stream the table
+                                Output each row as soon as it is read, instead of after all the input has been read. The column widths are set from the first ROWS rows. Uses a constant amount of memory.
+        --widths <WIDTHS>   Column widths
+                                Set fixed column widths for a streamed table. Implies --stream. Provide either a comma separated list of widths or specify this option multiple times, once for each column.
+    -T, --truncate          Truncate cells that do not fit in their column (default)
+                                Used with --stream.
+    -W, --wrap              Wrap cells that do not fit in their column
+                                Used with --stream.
+    -e, --header-repeat     Repeat the header row on each page
+                                Used with --stream.
+        --group-by <COLUMNS> Group the rows by these columns
+                                Output a row for each group of rows with the same cells of the columns, with the aggregates of --agg, instead. Provide a comma separated list of columns, numbered from 1. The rows are grouped as they are read, so only the groups are kept in memory, except with --tail. The groups are in the order that they first appear in the input and can be sorted with --sort, where the columns are those of the output. The first row is used for the column names with --header-row. Not supported with --stream.
+        --agg <AGGREGATES>  Aggregates of each group (default count)
+                                Provide a comma separated list of functions, each followed by a colon and a column, numbered from 1 (e.g. sum:5,count,max:4,p99:4). The functions are: count, sum, min, max, mean and pN, the Nth percentile (e.g. p50 or p99.9), which is estimated in bounded memory. count without a column is the number of rows. Only the cells that are numbers are used. Without --group-by, all the rows are one group.
+        --stats             Output summary statistics of each numeric column instead
+                                Outputs the count, minimum, maximum, mean, standard deviation and 50th, 90th, 99th and 99.9th percentiles of the cells that are numbers. The input is summarized as it is read and the percentiles are estimated, so it uses a constant amount of memory, except with --tail. The first row is used for the column names with --header-row. Not supported with --stream.
+        --columns-fill[=WIDTH] Fill the lines with as many rows as fit
+                                Output the rows side by side, as many as fit in WIDTH terminal columns (default the width of the terminal), like the column command. The row and column names are not used. Not supported with --stream.
+        --profile[=FORMAT]  Output a profile of the run to standard error
+                                Outputs the time of each phase: option parsing, input (reading and tokenizing), grouping with --group-by or --agg, sorting with --sort, layout, rendering and the final write, or setlocale and streaming with --stream. Also outputs the number of bytes read, rows, cells and heap allocations and the peak resident set size. <FORMAT> can be: text (default), json.
     -S, --style <STYLE>     Border style (default 'light')
                                 <STYLE> can be:
                                     ascii:          ASCII
@@ -146,6 +3211,10 @@ Examples:
     $ printf 'a:b:c\n1::3\n' | )"
 		 << programname << R"( --separator ':'
 
+    Output table of CSV with header row
+    $ printf 'Name,Note\n"Doe, Jane","Said ""hi"""\n' | )"
+		 << programname << R"( --csv --header-row
+
     Output table with header row
     $ ls -l --color | tail -n +2 | )"
 		 << programname << R"d( --header-row --columns 'PERM,LINKS,OWNER,GROUP,SIZE,MONTH,DAY,HH:MM/YEAR,NAME'
@@ -159,8 +3228,16 @@ Examples:
 		 << programname << R"d( --header-row --columns 'x,y'
 
     Output sorted table (Bash syntax)
-    $ for i in {0..4}; do for j in {0..4}; do echo -n "$(( RANDOM * RANDOM )) "; done; echo; done | sort -n -k 1 | )d"
-		 << programname << R"d(
+    $ for i in {0..4}; do for j in {0..4}; do echo -n "$(( RANDOM * RANDOM )) "; done; echo; done | )d"
+		 << programname << R"d( --sort 1n
+
+    Output the number and total size of the files of each owner
+    $ ls -l | tail -n +2 | )d"
+		 << programname << R"d( --group-by 3 --agg 'count,sum:5' --sort 3nr
+
+    Output streamed table, updated every second
+    $ vmstat 1 | tail -n +2 | )d"
+		 << programname << R"d( --stream 1 --right --header-row --header-repeat
 
     Output a table in each style (Bash syntax)
     $ for s in ascii basic light heavy double arc light-dashed heavy-dashed; do printf 'a b c\n1 2 3\n' | )d"
@@ -171,6 +3248,11 @@ Examples:
 
 int main(int argc, char *argv[])
 {
+	// Declared first, so that the output is written before it is restored
+	outputbuf aoutputbuf(cout, STDOUT_FILENO);
+	// Then, so that it outputs the profile after everything else has finished
+	profiler aprofiler;
+
 	vector<string> aheaderrow;
 	vector<string> aheadercolumn;
 
@@ -179,10 +3261,33 @@ int main(int argc, char *argv[])
 
 	const char *delimiter = nullptr;
 	char line_delim = '\n';
+	// Default separator of quoted fields with --csv or --tsv
+	const char *quoted_delimiter = nullptr;
+	selection fields;
+	limits alimits;
+	vector<sortkey> keys;
+
+	bool group = false;
+	vector<size_t> groupcolumns;
+	vector<aggregate> aggregates;
 
 	bool keep_empty_lines = false;
 
+	unsigned jobs = 0;
+
+	bool stream = false;
+	size_t sample = 0;
+	vector<size_t> columnwidth;
+	bool wrap = false;
+	bool header_repeat = false;
+
+	bool stats = false;
+
+	bool fill = false;
+	size_t fillwidth = 0;
+
 	const int frombase = 0;
+	char *p;
 
 	// https://stackoverflow.com/a/38646489
 
@@ -191,15 +3296,29 @@ int main(int argc, char *argv[])
 		{"name", required_argument, nullptr, 'n'},
 		{"columns", required_argument, nullptr, 'N'},
 		{"rows", required_argument, nullptr, 'M'},
-		// {"header-repeat", no_argument, NULL, 'e'},
+		{"header-repeat", no_argument, nullptr, 'e'},
 		{"left", no_argument, nullptr, 'l'},
 		{"right", no_argument, nullptr, 'R'},
-		// {"truncate", no_argument, NULL, 'T'},
-		// {"wrap", no_argument, NULL, 'W'},
+		{"truncate", no_argument, nullptr, 'T'},
+		{"wrap", no_argument, nullptr, 'W'},
+		{"stream", required_argument, nullptr, STREAM_OPTION},
+		{"widths", required_argument, nullptr, WIDTHS_OPTION},
+		{"stats", no_argument, nullptr, STATS_OPTION},
+		{"profile", optional_argument, nullptr, PROFILE_OPTION},
+		{"columns-fill", optional_argument, nullptr, FILL_OPTION},
 		{"separator", required_argument, nullptr, 's'},
 		{"delimiter", required_argument, nullptr, 'd'},
+		{"csv", no_argument, nullptr, CSV_OPTION},
+		{"tsv", no_argument, nullptr, TSV_OPTION},
+		{"fields", required_argument, nullptr, FIELDS_OPTION},
+		{"head", required_argument, nullptr, HEAD_OPTION},
+		{"tail", required_argument, nullptr, TAIL_OPTION},
+		{"sort", required_argument, nullptr, SORT_OPTION},
+		{"group-by", required_argument, nullptr, GROUP_BY_OPTION},
+		{"agg", required_argument, nullptr, AGG_OPTION},
 		{"keep-empty-lines", no_argument, nullptr, 'L'},
 		{"zero-terminated", no_argument, nullptr, 'z'},
+		{"jobs", required_argument, nullptr, 'j'},
 		{"header-row", no_argument, nullptr, 'r'},
 		{"header-column", no_argument, nullptr, 'c'},
 		{"no-border", no_argument, nullptr, 'b'},
@@ -213,7 +3332,7 @@ int main(int argc, char *argv[])
 	int option_index = 0;
 	int c = 0;
 
-	while ((c = getopt_long(argc, argv, "bcd:lrn:p:s:t:zCLRS:M:N:", long_options, &option_index)) != -1)
+	while ((c = getopt_long(argc, argv, "bcd:ej:lrn:p:s:t:zCLRS:M:N:TW", long_options, &option_index)) != -1)
 	{
 		switch (c)
 		{
@@ -223,6 +3342,22 @@ int main(int argc, char *argv[])
 		case 'c':
 			aoptions.headercolumn = true;
 			break;
+		case 'e':
+			header_repeat = true;
+			break;
+		case 'j':
+			jobs = strtoul(optarg, &p, frombase);
+			if (*p)
+			{
+				cerr << "Usage: <JOBS> is not a valid integer number: " << quoted(optarg) << ".\n";
+				return 1;
+			}
+			if (errno == ERANGE)
+			{
+				cerr << "Error: Integer number for <JOBS> is too large to input: " << quoted(optarg) << " (" << strerror(errno) << ").\n";
+				return 1;
+			}
+			break;
 		case 'l':
 			aoptions.alignment = ios_base::left;
 			break;
@@ -261,6 +3396,131 @@ int main(int argc, char *argv[])
 		case 'z':
 			line_delim = '\0';
 			break;
+		case 'T':
+			wrap = false;
+			break;
+		case 'W':
+			wrap = true;
+			break;
+		case STREAM_OPTION:
+			sample = strtoul(optarg, &p, frombase);
+			if (*p)
+			{
+				cerr << "Usage: <ROWS> is not a valid integer number: " << quoted(optarg) << ".\n";
+				return 1;
+			}
+			if (errno == ERANGE)
+			{
+				cerr << "Error: Integer number for <ROWS> is too large to input: " << quoted(optarg) << " (" << strerror(errno) << ").\n";
+				return 1;
+			}
+			stream = true;
+			break;
+		case WIDTHS_OPTION:
+			for (const auto &token : split(string(optarg)))
+			{
+				columnwidth.push_back(strtoul(token.c_str(), &p, frombase));
+				if (*p)
+				{
+					cerr << "Usage: <WIDTHS> is not a valid integer number: " << quoted(token) << ".\n";
+					return 1;
+				}
+				if (errno == ERANGE)
+				{
+					cerr << "Error: Integer number for <WIDTHS> is too large to input: " << quoted(token) << " (" << strerror(errno) << ").\n";
+					return 1;
+				}
+			}
+			stream = true;
+			break;
+		case STATS_OPTION:
+			stats = true;
+			break;
+		case PROFILE_OPTION:
+			aprofiler.enabled = true;
+			if (optarg)
+				aprofiler.format = xargmatch("--profile", optarg, profile_args, size(profile_args), profile_types);
+			countallocations = true;
+			break;
+		case FILL_OPTION:
+			if (optarg)
+			{
+				fillwidth = strtoul(optarg, &p, frombase);
+				if (*p)
+				{
+					cerr << "Usage: <WIDTH> is not a valid integer number: " << quoted(optarg) << ".\n";
+					return 1;
+				}
+				if (errno == ERANGE)
+				{
+					cerr << "Error: Integer number for <WIDTH> is too large to input: " << quoted(optarg) << " (" << strerror(errno) << ").\n";
+					return 1;
+				}
+			}
+			fill = true;
+			break;
+		case CSV_OPTION:
+			quoted_delimiter = ",";
+			break;
+		case TSV_OPTION:
+			quoted_delimiter = "\t";
+			break;
+		case FIELDS_OPTION:
+			if (!fields.parse(optarg))
+			{
+				cerr << "Usage: <LIST> is not a valid list of fields: " << quoted(optarg) << ".\n";
+				return 1;
+			}
+			break;
+		case HEAD_OPTION:
+			alimits.head = strtoul(optarg, &p, frombase);
+			if (*p)
+			{
+				cerr << "Usage: <ROWS> is not a valid integer number: " << quoted(optarg) << ".\n";
+				return 1;
+			}
+			if (errno == ERANGE)
+			{
+				cerr << "Error: Integer number for <ROWS> is too large to input: " << quoted(optarg) << " (" << strerror(errno) << ").\n";
+				return 1;
+			}
+			break;
+		case TAIL_OPTION:
+			alimits.tail = strtoul(optarg, &p, frombase);
+			if (*p)
+			{
+				cerr << "Usage: <ROWS> is not a valid integer number: " << quoted(optarg) << ".\n";
+				return 1;
+			}
+			if (errno == ERANGE)
+			{
+				cerr << "Error: Integer number for <ROWS> is too large to input: " << quoted(optarg) << " (" << strerror(errno) << ").\n";
+				return 1;
+			}
+			break;
+		case SORT_OPTION:
+			if (!parsekeys(optarg, keys))
+			{
+				cerr << "Usage: <KEYS> is not a valid list of sort keys: " << quoted(optarg) << ".\n";
+				return 1;
+			}
+			break;
+		case GROUP_BY_OPTION:
+			if (!parsecolumns(optarg, groupcolumns))
+			{
+				cerr << "Usage: <COLUMNS> is not a valid list of columns: " << quoted(optarg) << ".\n";
+				return 1;
+			}
+			group = true;
+			break;
+		case AGG_OPTION:
+			if (!parseaggregates(optarg, aggregates))
+			{
+				cerr << "Usage: <AGGREGATES> is not a valid list of aggregates: " << quoted(optarg) << ".\n";
+				return 1;
+			}
+			group = true;
+			break;
 		case GETOPT_HELP_CHAR:
 			usage(argv[0]);
 			return 0;
@@ -275,57 +3535,613 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	vector<vector<string>> aarray;
+	const bool csv = quoted_delimiter;
+	if (csv and !delimiter)
+		delimiter = quoted_delimiter;
 
-	if (optind < argc)
+	alimits.first = aoptions.headerrow and aheaderrow.empty() ? 1 : 0;
+
+	aprofiler.phase("options");
+
+	if (group and stats)
 	{
-		for (int i = optind; i < argc; ++i)
+		cerr << "Error: --group-by and --agg are not supported with --stats.\n";
+		return 1;
+	}
+
+	if (stream and (stats or fill))
+	{
+		cerr << "Error: --stats and --columns-fill are not supported with --stream.\n";
+		return 1;
+	}
+
+	if (stream)
+	{
+		if (!keys.empty() or group)
+		{
+			cerr << "Error: --sort, --group-by and --agg are not supported with --stream.\n";
+			return 1;
+		}
+
+		setlocale(LC_ALL, "");
+
+		aprofiler.phase("setlocale");
+
+		const delimiters adelimiters(delimiter, line_delim, csv, fields);
+		const bool fixed = !columnwidth.empty();
+		size_t columns = columnwidth.size();
+
+		if (aoptions.headerrow and aheaderrow.empty())
+			sample = max(sample, size_t(1));
+		else if (fixed)
+			sample = 0;
+		else if (!sample)
+			sample = 1;
+
+		if (aheadercolumn.size() == 1)
+			aheadercolumn = split(aheadercolumn[0]);
+
+		// The first rows, which the column widths are computed from
+		vector<string> lines;
+		lines.reserve(sample);
+		bool started = false;
+
+		size_t row = 0;
+		bool first = true;
+		bool warned = false;
+
+		size_t page = 0;
+		size_t alines = 0;
+		if (header_repeat)
 		{
-			vector<vector<string>> aaarray;
+			struct winsize w;
+			if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) != -1)
+				page = w.ws_row;
+		}
 
-			if (string(argv[i]) == "-")
+		auto header = [&]()
+		{
+			const vector<string_view> array(aheaderrow.cbegin(), aheaderrow.cend());
+			alines += outputrow(array, columnwidth, true, wrap, aoptions);
+			if (aoptions.headerrow or aoptions.cellborder)
+				alines += outputborder(columnwidth, 1, aoptions);
+			first = true;
+		};
+
+		auto output = [&](vector<string_view> &array)
+		{
+			if (!columns)
+				return;
+
+			if (!aheadercolumn.empty())
+				array.insert(array.begin(), row < aheadercolumn.size() ? string_view(aheadercolumn[row]) : string_view());
+			++row;
+
+			++aprofiler.rows;
+			aprofiler.cells += array.size();
+
+			if (array.size() != columns and (!array.empty() or !keep_empty_lines) and !warned)
+			{
+				cerr << "Warning: The rows of the array should have the same number of columns (" << columns << ").\n";
+				warned = true;
+			}
+
+			if (page and !aheaderrow.empty() and alines >= page)
+			{
+				alines = 0;
+				header();
+			}
+
+			if (aoptions.cellborder and !first)
+				alines += outputborder(columnwidth, 1, aoptions);
+			first = false;
+
+			alines += outputrow(array, columnwidth, false, wrap, aoptions);
+		};
+
+		auto start = [&]()
+		{
+			started = true;
+
+			vector<vector<string_view>> aarray;
+			aarray.reserve(lines.size());
+			list<string> escaped;
+			for (const auto &line : lines)
+			{
+				vector<string_view> array;
+				if (csv)
+					tokenize(string_view(line), adelimiters, array, escaped);
+				else
+					tokenize(string_view(line), adelimiters, array);
+				aarray.push_back(move(array));
+			}
+
+			if (aoptions.headerrow and aheaderrow.empty() and !aarray.empty())
 			{
-				aaarray = input(cin, delimiter, line_delim, keep_empty_lines);
+				if (!aheadercolumn.empty())
+					aheaderrow.emplace_back();
+				aheaderrow.insert(aheaderrow.end(), aarray[0].cbegin(), aarray[0].cend());
+				aarray.erase(aarray.begin());
+			}
+
+			if (!fixed)
+			{
+				for (const auto &array : aarray)
+					columns = max(columns, array.size());
+				if (!aheadercolumn.empty())
+					++columns;
+				columns = max(columns, aheaderrow.size());
+			}
+
+			if (!aheaderrow.empty())
+			{
+				if (aheaderrow.size() == 1 and columns != 1)
+					aheaderrow = split(aheaderrow[0]);
+
+				if (aheaderrow.size() != columns)
+				{
+					cerr << "Warning: The header row does not have the same number of columns (" << aheaderrow.size() << ") as the array (" << columns << ").\n";
+					aheaderrow.resize(columns);
+				}
+			}
+
+			if (!fixed)
+			{
+				columnwidth.assign(columns, 0);
+
+				const size_t k = aheadercolumn.empty() ? 0 : 1;
+				size_t width;
+				for (size_t j = 0; j < aheaderrow.size(); ++j)
+				{
+					fit(aheaderrow[j], SIZE_MAX, width);
+					columnwidth[j] = max(columnwidth[j], width);
+				}
+				for (size_t i = 0; i < aheadercolumn.size() and k; ++i)
+				{
+					fit(aheadercolumn[i], SIZE_MAX, width);
+					columnwidth[0] = max(columnwidth[0], width);
+				}
+				for (const auto &array : aarray)
+				{
+					for (size_t j = 0; j < array.size() and j + k < columns; ++j)
+					{
+						fit(array[j], SIZE_MAX, width);
+						columnwidth[j + k] = max(columnwidth[j + k], width);
+					}
+				}
+			}
+
+			if (!columns)
+				return;
+
+			if (aoptions.title)
+				cout << aoptions.title << '\n';
+			if (aoptions.tableborder)
+				alines += outputborder(columnwidth, 0, aoptions);
+			if (!aheaderrow.empty())
+				header();
+
+			for (auto &array : aarray)
+				output(array);
+
+			lines.clear();
+			lines.shrink_to_fit();
+		};
 
-				aarray.insert(aarray.end(), aaarray.cbegin(), aaarray.cend());
+		// With --tail, the last rows in a ring buffer, which are only output after all the input has been read
+		vector<string> ring;
+		size_t ringrows = 0;
+
+		vector<string_view> array;
+		list<string> escaped;
+
+		// Output a row, or keep it until the column widths are computed
+		auto aline = [&](const string &line)
+		{
+			if (!started)
+			{
+				lines.push_back(line);
+				if (lines.size() >= sample)
+					start();
+				return;
+			}
+
+			array.clear();
+			if (csv)
+			{
+				escaped.clear();
+				tokenize(string_view(line), adelimiters, array, escaped);
 			}
 			else
+				tokenize(string_view(line), adelimiters, array);
+			output(array);
+		};
+
+		auto aread = [&](istream &in)
+		{
+			string line;
+			string more;
+
+			while ((alimits.first or alimits.head) and getline(in, line, line_delim))
+			{
+				bytesread += line.size() + 1;
+
+				// A quoted field can continue on the next lines
+				if (csv)
+				{
+					size_t quotes = count(line.cbegin(), line.cend(), '"');
+					while (quotes & 1 and getline(in, more, line_delim))
+					{
+						bytesread += more.size() + 1;
+						quotes += count(more.cbegin(), more.cend(), '"');
+						line += line_delim;
+						line += more;
+					}
+				}
+
+				// The last line could be incomplete
+				if (readerror)
+					break;
+
+				if (!isrow(line, line_delim, csv, keep_empty_lines))
+					continue;
+
+				if (alimits.first)
+					--alimits.first;
+				else
+				{
+					--alimits.head;
+					if (alimits.tail != SIZE_MAX)
+					{
+						if (ring.size() < alimits.tail)
+							ring.push_back(move(line));
+						else if (alimits.tail)
+							ring[ringrows % alimits.tail] = move(line);
+						++ringrows;
+						continue;
+					}
+				}
+
+				aline(line);
+
+				if (in.rdbuf()->in_avail() <= 0)
+					cout.flush();
+			}
+		};
+
+		// Compressed inputs are decompressed on another thread
+		auto areadfd = [&](const int fd)
+		{
+			readerbuf buf(fd);
+			istream in(&buf);
+			aread(in);
+		};
+
+		if (!sample)
+			start();
+
+		if (optind < argc)
+		{
+			for (int i = optind; i < argc and (alimits.first or alimits.head); ++i)
 			{
-				ifstream fin(argv[i]);
+				if (string(argv[i]) == "-")
+				{
+					areadfd(STDIN_FILENO);
+				}
+				else
+				{
+					const int fd = open(argv[i], O_RDONLY);
+
+					if (fd != -1)
+					{
+						areadfd(fd);
+
+						close(fd);
+					}
+					else
+						cerr << "Error: Unable to open the " << quoted(argv[i]) << " file (" << strerror(errno) << ").\n";
+				}
+			}
+		}
+		else
+		{
+			areadfd(STDIN_FILENO);
+		}
+
+		for (size_t i = ringrows - ring.size(); i < ringrows; ++i)
+			aline(ring[i % ring.size()]);
 
-				if (fin)
+		if (!started)
+			start();
+
+		if (columns and aoptions.tableborder)
+			outputborder(columnwidth, 2, aoptions);
+
+		// Reading, tokenizing and rendering are interleaved when streaming
+		aprofiler.phase("stream");
+
+		return readerror ? 1 : 0;
+	}
+
+	if (!jobs)
+		jobs = max(thread::hardware_concurrency(), 1u);
+
+	cellarray<string_view> aarray;
+	// Interned cells of the inputs that were read instead of mapped (e.g. pipes and compressed files) and quoted fields with escaped quotes, which the cells are views into
+	list<string> buffers;
+
+	// The header row is always kept with --head and --tail
+	const size_t first = alimits.first;
+
+	// Summaries of the numbers of each column with --stats
+	vector<summary> asummaries;
+
+	// Summarize the rows from start on
+	// They are split into parts of a fixed size, which are summarized on separate threads, jobs at a time. Their summaries are then merged in order, so that the estimated percentiles do not depend on the number of threads.
+	auto summarize = [&](const cellarray<string_view> &array, const size_t start)
+	{
+		size_t columns = asummaries.size();
+		for (size_t k = start; k < array.size(); ++k)
+			columns = max(columns, array[k].size());
+		asummaries.resize(columns);
+
+		const size_t block = 1 << 16;
+		const size_t parts = (array.size() - start + block - 1) / block;
+
+		for (size_t apart = 0; apart < parts; apart += jobs)
+		{
+			vector<vector<summary>> summaries(min(static_cast<size_t>(jobs), parts - apart), vector<summary>(columns));
+
+			parallel(summaries.size(), jobs, [&](const size_t i)
+					 {
+				string temp;
+				const size_t begin = start + ((apart + i) * block);
+				for (size_t k = begin; k < min(begin + block, array.size()); ++k)
 				{
-					aaarray = input(fin, delimiter, line_delim, keep_empty_lines);
+					const auto &row = array[k];
+					for (size_t j = 0; j < row.size(); ++j)
+					{
+						if (row[j].empty())
+							continue;
+
+						// Only cells that are entirely a number are included
+						temp = row[j];
+						char *p;
+						const long double number = strtold(temp.c_str(), &p);
+						if (!*p)
+							summaries[i][j].add(number);
+					}
+				} });
+
+			for (const auto &temp : summaries)
+				for (size_t j = 0; j < columns; ++j)
+					asummaries[j].merge(temp[j]);
+		}
+	};
+
+	if (group and aggregates.empty())
+		aggregates.push_back({aggregate_count, SIZE_MAX, 0, "count"});
+
+	grouper agrouper(groupcolumns, aggregates, jobs);
+
+	// With --stats, --group-by or --agg, the rows of each block that is read are summarized or grouped and the block is then freed, instead of keeping all of the input
+	// The files are then read instead of mapped, so that only a block at a time is in memory. Not with --tail, since its rows are only known once all of the inputs are read.
+	const bool consume = (stats or group) and alimits.tail == SIZE_MAX;
+	vector<string> headerrow;
+	size_t rowsread = 0;
+	size_t cellsread = 0;
+
+	auto consumeblock = [&](const cellarray<string_view> &array)
+	{
+		size_t start = 0;
+		if (rowsread < first and !array.empty())
+		{
+			headerrow.assign(array[0].cbegin(), array[0].cend());
+			start = 1;
+		}
+		rowsread += array.size();
+		if (aprofiler.enabled)
+			cellsread += array.count();
+
+		if (group)
+			agrouper.add(array, start);
+		else
+			summarize(array, start);
+	};
+
+	// Memory map the input if it is an uncompressed regular file, otherwise read it as a stream
+	auto inputfd = [&](const int fd)
+	{
+		string_view buffer;
+		if (consume)
+			input(fd, delimiter, line_delim, csv, fields, keep_empty_lines, jobs, alimits, consumeblock);
+		else if (mapfile(fd, buffer))
+			aarray.append(input(buffer, delimiter, line_delim, csv, fields, keep_empty_lines, jobs, buffers, alimits));
+		else
+			aarray.append(input(fd, delimiter, line_delim, csv, fields, keep_empty_lines, jobs, buffers, alimits));
+	};
+
+	if (optind < argc)
+	{
+		for (int i = optind; i < argc and (alimits.first or alimits.head); ++i)
+		{
+			if (string(argv[i]) == "-")
+			{
+				inputfd(STDIN_FILENO);
+			}
+			else
+			{
+				const int fd = open(argv[i], O_RDONLY);
 
-					aarray.insert(aarray.end(), aaarray.cbegin(), aaarray.cend());
+				if (fd != -1)
+				{
+					inputfd(fd);
 
-					// fin.close();
+					close(fd);
 				}
 				else
 					cerr << "Error: Unable to open the " << quoted(argv[i]) << " file (" << strerror(errno) << ").\n";
 			}
+
+			// Only the last rows of all the inputs are kept with --tail
+			const size_t header = first - alimits.first;
+			if (alimits.tail != SIZE_MAX and aarray.size() - header > alimits.tail)
+				aarray.erase(header, aarray.size() - alimits.tail);
 		}
 	}
 	else
 	{
-		aarray = input(cin, delimiter, line_delim, keep_empty_lines);
+		inputfd(STDIN_FILENO);
+	}
+
+	if (readerror)
+		return 1;
+
+	if (!consume)
+	{
+		rowsread = aarray.size();
+		if (aprofiler.enabled)
+			cellsread = aarray.count();
+		if (first and !aarray.empty())
+			headerrow.assign(aarray[0].cbegin(), aarray[0].cend());
 	}
 
-	if (aarray.empty())
+	aprofiler.phase("input");
+
+	aprofiler.rows = rowsread;
+	aprofiler.cells = cellsread;
+
+	if (!rowsread)
 		return 0;
 
-	const size_t max = (*max_element(aarray.cbegin(), aarray.cend(), [](const auto &a, const auto &b)
-									 { return a.size() < b.size(); }))
-						   .size();
+	// The first row has the column names with --header-row, unless they are provided
+	vector<string> anames = aheaderrow;
+	if (anames.size() == 1)
+		anames = split(anames[0]);
+	if (first)
+		anames = headerrow;
+
+	auto name = [&](const size_t j)
+	{ return j < anames.size() ? anames[j] : to_string(j + 1); };
+
+	if (group)
+	{
+		if (!consume)
+			agrouper.add(aarray, first);
+
+		vector<string> header;
+		for (const size_t j : groupcolumns)
+			header.push_back(name(j));
+		for (const auto &aaggregate : aggregates)
+			header.push_back(aaggregate.column == SIZE_MAX ? aaggregate.name : aaggregate.name + '(' + name(aaggregate.column) + ')');
+
+		const vector<vector<string>> agroups = agrouper.groups();
+
+		aprofiler.phase("group");
+
+		cellarray<string_view> agrouparray;
+		agrouparray.reserve(agroups.size(), agroups.size() * header.size());
+		for (const auto &row : agroups)
+		{
+			for (const auto &cell : row)
+				agrouparray.add(cell);
+			agrouparray.endrow();
+		}
+
+		if (!keys.empty())
+		{
+			agrouparray.reorder(0, sortrows(agrouparray, 0, keys, jobs));
+
+			aprofiler.phase("sort");
+		}
+
+		tables::options goptions = aoptions;
+		goptions.headerrow = true;
+
+		const int code = tables::array(agrouparray, header.data(), nullptr, goptions);
+
+		aprofiler.phase("render");
+
+		return code;
+	}
+
+	if (stats)
+	{
+		if (!consume)
+			summarize(aarray, first);
+
+		const vector<string> header = {"Column", "Count", "Min", "Max", "Mean", "Std Dev", "p50", "p90", "p99", "p99.9"};
+		vector<vector<string>> astats;
+
+		for (size_t j = 0; j < asummaries.size(); ++j)
+		{
+			auto &asummary = asummaries[j];
+			if (!asummary.count)
+				continue;
+
+			const long double values[] = {asummary.min, asummary.max, asummary.mean, asummary.stddev(), asummary.quantile(0.5), asummary.quantile(0.9), asummary.quantile(0.99), asummary.quantile(0.999)};
+
+			vector<string> row = {name(j), to_string(asummary.count)};
+			for (const long double value : values)
+			{
+				ostringstream strm;
+				strm << value;
+				row.push_back(strm.str());
+			}
+			astats.push_back(row);
+		}
+
+		if (astats.empty())
+		{
+			cerr << "Error: The input does not have any numeric columns.\n";
+			return 1;
+		}
+
+		tables::options soptions = aoptions;
+		soptions.headerrow = true;
+		soptions.headercolumn = true;
+
+		aprofiler.phase("stats");
+
+		const int code = tables::array(astats, header.data(), nullptr, soptions);
+
+		aprofiler.phase("render");
 
-	for (auto &array : aarray)
+		return code;
+	}
+
+	if (!keys.empty())
+	{
+		aarray.reorder(first, sortrows(aarray, first, keys, jobs));
+
+		aprofiler.phase("sort");
+	}
+
+	size_t max = 0;
+	for (const auto &array : aarray)
+		max = std::max(max, array.size());
+
+	for (const auto &array : aarray)
+		if (array.size() != max and (!array.empty() or !keep_empty_lines))
+			cerr << "Warning: The rows of the array should have the same number of columns (" << max << ").\n";
+
+	aarray.pad(max);
+
+	if (fill)
 	{
-		if (array.size() != max)
+		if (!fillwidth)
 		{
-			if (!array.empty() or !keep_empty_lines)
-				cerr << "Warning: The rows of the array should have the same number of columns (" << max << ").\n";
-			array.resize(max);
+			struct winsize w;
+			fillwidth = ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) != -1 and w.ws_col ? w.ws_col : 80;
 		}
+
+		aprofiler.phase("layout");
+
+		const int code = column(fillwidth, aarray, aoptions);
+
+		aprofiler.phase("render");
+
+		return code;
 	}
 
 	size_t rows = aarray.size();
@@ -362,5 +4178,11 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	return tables::array(aarray, aheaderrow.data(), aheadercolumn.data(), aoptions);
+	aprofiler.phase("layout");
+
+	const int code = tables::array(aarray, aheaderrow.data(), aheadercolumn.data(), aoptions);
+
+	aprofiler.phase("render");
+
+	return code;
 }